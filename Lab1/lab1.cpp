@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <random>
@@ -5,6 +6,8 @@
 
 #include "utils.h"
 #include "render.h"
+#include "trajectory.h"
+#include "motion.h"
 
 //===== Main parameters =====
 const int width {800}, height {800};        //Width and height of the environment
@@ -20,6 +23,7 @@ const int robot_y_min {500};                //Minimum robot y position
 const int goal_y_max {300};                 //Maximum goal y position
 int obj_x, obj_y, obj_width, obj_height;    //Parameters for object position/size
 int num_objects {0};                        //Number of obstacles in environment
+int max_speed {1};                          //Pixels the robot may move per time step
 
 // Grid utility class. Students will not use this for lab 1
 grid_util grid(width, height, min_obj_size, max_obj_size);
@@ -28,7 +32,7 @@ grid_util grid(width, height, min_obj_size, max_obj_size);
 random_generator rand_gen;
 
 // Vector of robot positions to pass to renderer code. Update this after each time step!
-std::vector<std::vector<int>> robot_pos;
+trajectory robot_pos;
 
 // Did mission succeed? Update this to make sure it succeeds if robot reaches goal, failure if it hits wall.
 bool succeed;
@@ -75,13 +79,19 @@ int main(int argc, char const *argv[])
     grid.writeGridToCSV("grid.csv");
 
     // place the first robot position to robot_pos
-    robot_pos.push_back({robot.x, robot.y});
+    robot_pos.push_back(robot.x, robot.y);
 
     // maximum count. Close the loop after 3600 iterations. As the window is displayed at 60fps, this is 60 seconds.
     int max_count=0;
 
-    // Robot was moving too slow so to adjust, the following was done below
-    const int step_size = 1;
+    // Task 7: the closest position at which the robot touches the goal. each coordinate is the
+    // robot's own, clamped to the range where its box overlaps the goal's and stays in bounds
+    int target_x = std::max(goal.x - robot.width + 1, std::min(robot.x, goal.x + goal.width - 1));
+    int target_y = std::max(goal.y - robot.height + 1, std::min(robot.y, goal.y + goal.height - 1));
+    target_x = std::max(0, std::min(target_x, width - robot.width));
+    target_y = std::max(0, std::min(target_y, height - robot.height));
+    // integer line from the robot to that position
+    line_motion motion(robot.x, robot.y, target_x, target_y, max_speed);
 
     // main while loop
     while (true)
@@ -118,20 +128,20 @@ if (hasRobotReachedGoal(robot, goal)) {
     //}
 //}
 
-    // Task 4
-       if (robot.y != goal.y) {
-    if (robot.y < goal.y) {
-        robot.y += 1;
-    } else { // robot.y > goal.y
-        robot.y -= 1;
-    }
-} else if (robot.x != goal.x) {
-    if (robot.x < goal.x) {
-        robot.x += 1;
-    } else { // robot.x > goal.x
-        robot.x -= 1;
-    }
-}
+// Task 4
+//if (robot.y != goal.y) {
+    //if (robot.y < goal.y) {
+        //robot.y += 1;
+    //} else { // robot.y > goal.y
+        //robot.y -= 1;
+    //}
+//} else if (robot.x != goal.x) {
+    //if (robot.x < goal.x) {
+        //robot.x += 1;
+    //} else { // robot.x > goal.x
+        //robot.x -= 1;
+    //}
+//}
 
 //Task 5
 //int dx = goal.x - robot.x;
@@ -164,99 +174,20 @@ if (hasRobotReachedGoal(robot, goal)) {
     //robot.y += static_cast<int>(std::round(uy));
 //}
 
-// Task 7: straight-line navigation to closest goal corner
-// Step 1: pick the closest corner
-int goal_corners[4][2] = {
-    {goal.x, goal.y},                           // top-left
-    {goal.x + goal.width - 1, goal.y},          // top-right  ( -1 to stay inside goal )
-    {goal.x, goal.y + goal.height - 1},         // bottom-left
-    {goal.x + goal.width - 1, goal.y + goal.height - 1} // bottom-right
-};
-
-double min_dist = 2000.0;
-int target_x = goal_corners[0][0];
-int target_y = goal_corners[0][1];
-
-for (int i = 0; i < 4; ++i) {
-    double dist = std::sqrt(
-        (goal_corners[i][0] - robot.x) * (goal_corners[i][0] - robot.x) +
-        (goal_corners[i][1] - robot.y) * (goal_corners[i][1] - robot.y)
-    );
-    if (dist < min_dist) {
-        min_dist = dist;
-        target_x = goal_corners[i][0];
-        target_y = goal_corners[i][1];
-    }
-}
-
-// Step 2: compute deltas & signs
-int dx = target_x - robot.x;
-int dy = target_y - robot.y;
-int sx = (dx > 0) ? 1 : -1;
-int sy = (dy > 0) ? 1 : -1;
-
-int abs_dx = std::abs(dx);
-int abs_dy = std::abs(dy);
-
-// Step 3: slope logic but always 1-pixel per iteration
-static bool x_first_set = false;
-static bool x_first;
-static int ratio = 0;
-static bool init = false;
-
-if (!init) {
-    // decide slope once at start
-    if (abs_dy > abs_dx) {           // slope > 1 → x is slow axis
-        ratio = abs_dy / abs_dx;     // floor(Δy/Δx)
-        x_first = true;
-    } else {                          // slope ≤ 1 → y is slow axis
-        ratio = (abs_dy == 0) ? 0 : abs_dx / abs_dy;
-        x_first = false;
-    }
-    init = true;
-}
-
-// Bresenham-like stepping:
-// keep counters so we only move 1 pixel each loop
-static int counter = 0;
-
-if (robot.x != target_x || robot.y != target_y) {
-
-    if (x_first) {
-        // slope > 1 → every loop move mostly in y, sometimes in x
-        if (abs_dx > 0) {
-            // move in y most of the time
-            robot.y += sy;
-            counter++;
-            if (counter >= ratio) {          // after ratio y-steps, step 1 in x
-                robot.x += sx;
-                abs_dx--;
-                counter = 0;
-            }
-        } else if (robot.y != target_y) {
-            // finished x, just close in y
-            robot.y += sy;
-        }
-    } else {
-        // slope ≤ 1 → every loop move mostly in x, sometimes in y
-        if (abs_dy > 0) {
-            // move in x most of the time
-            robot.x += sx;
-            counter++;
-            if (counter >= ratio) {          // after ratio x-steps, step 1 in y
-                robot.y += sy;
-                abs_dy--;
-                counter = 0;
-            }
-        } else if (robot.x != target_x) {
-            // finished y, just close in x
-            robot.x += sx;
-        }
-    }
+// Task 7: straight-line navigation to the closest position touching the goal (picked before the
+// loop), max_speed pixels per time step along the line. each coordinate only reaches the range
+// where the boxes overlap at the end of the line, and a line between two points in bounds stays in
+// bounds, so nothing needs checking between steps: the line is recorded in one call and the checks
+// above see where it ends
+if (!motion.done() && max_count < 3600) {
+    max_count += motion.emit(robot_pos, 3600 - max_count);
+    robot.x = motion.get_x();
+    robot.y = motion.get_y();
+    continue;
 }
 
         // place the current robot position at the time step to robot_pos
-        robot_pos.push_back({robot.x, robot.y});
+        robot_pos.push_back(robot.x, robot.y);
         max_count++;
 
         // if more than a minute passed (in render window), exit
@@ -0,0 +1,78 @@
+// straight line motion primitive
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "motion.h"
+
+// constructor. a motion that is already at its end
+line_motion::line_motion() {
+}
+
+line_motion::line_motion(int x0, int y0, int x1, int y1, int max_speed) {
+    start(x0, y0, x1, y1, max_speed);
+}
+
+// move from (x0, y0) to (x1, y1), at most max_speed pixels per step
+void line_motion::start(int x0, int y0, int x1, int y1, int max_speed) {
+    this->x = x0;
+    this->y = y0;
+    this->x1 = x1;
+    this->y1 = y1;
+    dx = std::abs(x1 - x0);
+    dy = -std::abs(y1 - y0);
+    sx = (x0 < x1) ? 1 : -1;
+    sy = (y0 < y1) ? 1 : -1;
+    err = dx + dy;
+    this->max_speed = std::max(max_speed, 1);
+}
+
+// one pixel along the line
+void line_motion::next_pixel() {
+    int e2 = 2*err;
+    if (e2 >= dy) {
+        err += dy;
+        x += sx;
+    }
+    if (e2 <= dx) {
+        err += dx;
+        y += sy;
+    }
+}
+
+// advance one time step and write the new point to (x, y). false if the end was already reached
+bool line_motion::step(int& x, int& y) {
+    if (done()) {
+        return false;
+    }
+    for (int k = 0; k < max_speed && !done(); k++) {
+        next_pixel();
+    }
+    x = this->x;
+    y = this->y;
+    return true;
+}
+
+// record up to max_steps time steps of the rest of the line into path. returns the steps taken
+int line_motion::emit(trajectory& path, int max_steps) {
+    int steps = 0;
+    for (; steps < max_steps && !done(); steps++) {
+        for (int k = 0; k < max_speed && !done(); k++) {
+            next_pixel();
+        }
+        path.push_back(x, y);
+    }
+    return steps;
+}
+
+bool line_motion::done() const {
+    return x == x1 && y == y1;
+}
+
+int line_motion::get_x() const {
+    return this->x;
+}
+
+int line_motion::get_y() const {
+    return this->y;
+}
@@ -7,6 +7,7 @@
 
 // #include "drawobjects.h"
 #include "utils.h"
+#include "trajectory.h"
 
 // Text colours
 const std::string RED = "\033[31m";   // Red text
@@ -26,16 +27,16 @@ void draw(
     sf::CircleShape &robot_draw,
     sf::Vector2f &robotPosition,
     std::vector<sf::RectangleShape> &objects_draw,
-    std::vector<std::vector<int>> &robot_pos,
+    const trajectory &robot_pos,
     sf::RectangleShape &goal_draw,
     std::vector<sf::RectangleShape>::iterator &i,
     bool &isPaused,
     bool &succeed,
     int &count
 ) {
-    if (count < robot_pos.size() && robot_pos[count].size() >= 2) {
-        robotPosition.x = robot_pos[count][0]; // Safe access
-        robotPosition.y = robot_pos[count][1]; // Safe access
+    if (count < robot_pos.size()) {
+        robotPosition.x = robot_pos[count].x; // Safe access
+        robotPosition.y = robot_pos[count].y; // Safe access
     } else {
         if (count < 200) {
             std::cerr << "Error: Accessing out of bounds for robot_pos at count: " << count << std::endl;
@@ -74,7 +75,7 @@ void draw(
 }
 
 void render_window(
-    std::vector<std::vector<int>> robot_pos,
+    const trajectory &robot_pos,
     std::vector<Object> objects, 
     Object robot, 
     Object goal, 
@@ -0,0 +1,42 @@
+// trajectory recorder for the robot positions rendered after the run
+// points are packed as two int16 (4 bytes each) in fixed size chunks, so recording never copies
+// or allocates per step. optional decimation and a ring mode that keeps only the latest points
+#ifndef TRAJECTORY
+#define TRAJECTORY
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct traj_point {
+    int16_t x, y;                       // environment is 800x800, well within int16
+};
+
+class trajectory {
+    static const size_t chunk_size = 4096;      // points per chunk (16 KB)
+    std::vector<std::vector<traj_point>> chunks;
+    size_t capacity;                    // ring mode: max points kept, 0 for unbounded
+    int decimation;                     // keep every n-th recorded point
+    size_t num_stored{0};               // points in the chunks
+    size_t start{0};                    // ring mode: slot of the oldest point
+    size_t num_recorded{0};             // calls to push_back, kept or not
+    traj_point last{0, 0};              // latest point, shown at the end even if decimated away
+    bool pending{false};                // last was skipped by decimation
+    private:
+        traj_point& slot(size_t);
+        const traj_point& slot(size_t) const;
+    public:
+        // constructor
+        trajectory(size_t capacity = 0, int decimation = 1);
+        // functions
+        void push_back(int, int);
+        void clear();
+        traj_point operator[](size_t) const;
+        traj_point back() const;
+        // getters
+        size_t size() const;
+        bool empty() const;
+        size_t get_num_recorded() const;
+};
+
+#endif
@@ -5,6 +5,44 @@
 
 #include "utils.h"
 #include "render.h"
+#include "trajectory.h"
+#include "motion.h"
+#include "nav_machine.h"
+
+// controller states and the events that move between them, see nav_machine.h
+enum nav_state : uint8_t {
+    NAV_APPROACH,                       // heading for the goal
+    NAV_AVOID,                          // clearing an obstacle
+    NAV_AT_GOAL,
+    NAV_FAILED,                         // out of bounds or out of time
+    NUM_NAV_STATES
+};
+
+enum nav_event : uint8_t {
+    EV_COLLISION,
+    EV_CLEARED,
+    EV_REACHED,
+    EV_LOST,
+    NUM_NAV_EVENTS
+};
+
+const char *const nav_state_names[NUM_NAV_STATES] = {"approach", "avoid", "at goal", "failed"};
+
+const uint8_t STAY = nav_machine::stay;
+const uint8_t nav_table[NUM_NAV_STATES][NUM_NAV_EVENTS] = {
+    //                COLLISION  CLEARED       REACHED      LOST
+    /* approach */   {NAV_AVOID, STAY,         NAV_AT_GOAL, NAV_FAILED},
+    /* avoid */      {STAY,      NAV_APPROACH, NAV_AT_GOAL, NAV_FAILED},
+    /* at goal */    {STAY,      STAY,         STAY,        STAY},
+    /* failed */     {STAY,      STAY,         STAY,        STAY}
+};
+
+// axis the robot was moving along when it collided
+enum collision_dir : uint8_t {
+    COLLISION_NONE,
+    COLLISION_X,
+    COLLISION_Y
+};
 
 //===== Main parameters =====
 const int width {800}, height {800};        //Width and height of the environment
@@ -20,6 +58,7 @@ const int robot_y_min {500};                //Minimum robot y position
 const int goal_y_max {300};                 //Maximum goal y position
 int obj_x, obj_y, obj_width, obj_height;    //Parameters for object position/size
 int num_objects {15};                       //Number of objects in environment
+int max_speed {1};                          //Pixels the robot may move per time step
 
 // Grid utility class
 grid_util grid(width, height, min_obj_size, max_obj_size);
@@ -28,7 +67,7 @@ grid_util grid(width, height, min_obj_size, max_obj_size);
 random_generator rand_gen;
 
 // Vector of velocity commands
-std::vector<std::vector<int>> robot_pos;
+trajectory robot_pos;
 
 // Did mission succeed?
 bool succeed;
@@ -81,7 +120,7 @@ double distance_to_goal(const Object& robot, const Object& goal) {
 
 // Task 2: Obstacle avoidance function
 //void obstacle_avoidance(Object& robot, const std::string& collision_direction, 
-//                       const grid_util& grid, std::vector<std::vector<int>>& robot_pos) {
+//                       const grid_util& grid, trajectory& robot_pos) {
 //    
 //    // Move perpendicular to the collision direction
 //    if (collision_direction == "y_direction") {
@@ -89,7 +128,7 @@ double distance_to_goal(const Object& robot, const Object& goal) {
 //        // Try moving right first
 //        while (is_collision(robot, grid)) {
 //            robot.x += 1;
-//            robot_pos.push_back({robot.x, robot.y}); // IMPORTANT: update position for rendering
+//            robot_pos.push_back(robot.x, robot.y); // IMPORTANT: update position for rendering
 //        }
 //    } 
 //    else if (collision_direction == "x_direction") {
@@ -97,82 +136,62 @@ double distance_to_goal(const Object& robot, const Object& goal) {
 //        // Try moving down first
 //        while (is_collision(robot, grid)) {
 //            robot.y += 1;
-//            robot_pos.push_back({robot.x, robot.y}); // IMPORTANT: update position for rendering
+//            robot_pos.push_back(robot.x, robot.y); // IMPORTANT: update position for rendering
 //        }
 //    }
 //}
 
 //Task 3
-void obstacle_avoidance(Object& robot, const std::string& collision_direction, 
-                       const grid_util& grid, std::vector<std::vector<int>>& robot_pos,
-                       const Object& goal) {
+// clear the obstacle perpendicular to the collision, on the side that ends closer to the goal.
+// grid.clearance gives both distances in a few lookups. sets the step (step_x, step_y) and returns
+// how many of them clear the obstacle, 0 if neither side does. the avoid state walks them
+int obstacle_avoidance(const Object& robot, collision_dir collision_direction,
+                       const grid_util& grid, const Object& goal,
+                       int& step_x, int& step_y) {
     
-    if (collision_direction == "y_direction") {
-        // Calculate position after avoiding right
-        Object robot_right = robot;
-        while (is_collision(robot_right, grid)) {
-            robot_right.x += 1;
-        }
-        double dist_right = distance_to_goal(robot_right, goal);
-        
-        // Calculate position after avoiding left
-        Object robot_left = robot;
-        while (is_collision(robot_left, grid)) {
-            robot_left.x -= 1;
-        }
-        double dist_left = distance_to_goal(robot_left, goal);
-        
-        // Choose optimal direction
-        if (dist_right < dist_left) {
-            while (is_collision(robot, grid)) {
-                robot.x += 1;
-                robot_pos.push_back({robot.x, robot.y});
-            }
-        } else {
-            while (is_collision(robot, grid)) {
-                robot.x -= 1;
-                robot_pos.push_back({robot.x, robot.y});
-            }
-        }
+    // moving along y: clear to the right or left. moving along x: clear downwards or upwards
+    int dx = 0, dy = 0;
+    if (collision_direction == COLLISION_Y) {
+        dx = 1;
     } 
-    else if (collision_direction == "x_direction") {
-        // Calculate position after avoiding DOWN
-        Object robot_down = robot;
-        while (is_collision(robot_down, grid)) {
-            robot_down.y += 1;
-        }
-        double dist_down = distance_to_goal(robot_down, goal);
-        
-        // Calculate position after avoiding UP
-        Object robot_up = robot;
-        while (is_collision(robot_up, grid)) {
-            robot_up.y -= 1;
-        }
-        double dist_up = distance_to_goal(robot_up, goal);
-        
-        // Choose optimal direction
-        if (dist_down < dist_up) {
-            while (is_collision(robot, grid)) {
-                robot.y += 1;
-                robot_pos.push_back({robot.x, robot.y});
-            }
-        } else {
-            while (is_collision(robot, grid)) {
-                robot.y -= 1;
-                robot_pos.push_back({robot.x, robot.y});
-            }
-        }
+    else if (collision_direction == COLLISION_X) {
+        dy = 1;
     }
+    else {
+        return 0;
+    }
+
+    // distance to free space both ways, -1 if that way leaves the environment
+    int dist_pos = grid.clearance(robot, dx, dy);
+    int dist_neg = grid.clearance(robot, -dx, -dy);
+    if (dist_pos < 0 && dist_neg < 0) {
+        return 0;
+    }
+
+    // Choose optimal direction
+    Object robot_pos_side = robot;
+    robot_pos_side.x += dist_pos*dx;
+    robot_pos_side.y += dist_pos*dy;
+    Object robot_neg_side = robot;
+    robot_neg_side.x -= dist_neg*dx;
+    robot_neg_side.y -= dist_neg*dy;
+    int sign = 1;
+    if (dist_pos < 0 || (dist_neg >= 0 && distance_to_goal(robot_pos_side, goal) >= distance_to_goal(robot_neg_side, goal))) {
+        sign = -1;
+    }
+    step_x = sign*dx;
+    step_y = sign*dy;
+    return (sign > 0) ? dist_pos : dist_neg;
 }
 //Task 2
 // Function to detect which direction robot was moving when collision occurred
-std::string get_collision_direction(const Object& current_robot, const Object& previous_robot) {
+collision_dir get_collision_direction(const Object& current_robot, const Object& previous_robot) {
     if (current_robot.x != previous_robot.x) {
-        return "x_direction";
+        return COLLISION_X;
     } else if (current_robot.y != previous_robot.y) {
-        return "y_direction";
+        return COLLISION_Y;
     }
-    return "unknown";
+    return COLLISION_NONE;
 }
 
 int main(int argc, char const *argv[])
@@ -194,7 +213,10 @@ int main(int argc, char const *argv[])
 
     grid.writeGridToCSV("grid.csv");
 
-    robot_pos.push_back({robot.x, robot.y});
+    // run lengths of the obstacles (value 2) for the clearance queries of obstacle_avoidance
+    grid.build_runs(2);
+
+    robot_pos.push_back(robot.x, robot.y);
 
     // maximum count. Close the loop after 3600 iterations. As the window is displayed at 60fps, this is 60 seconds.
     int max_count = 0;
@@ -202,6 +224,12 @@ int main(int argc, char const *argv[])
 
 //Task 2
  Object previous_robot = robot;
+ // current leg towards the goal, see below
+ line_motion motion;
+ // approach/avoid state, with per state profiling
+ nav_machine nav(&nav_table[0][0], nav_state_names, NUM_NAV_STATES, NUM_NAV_EVENTS, NAV_APPROACH);
+ // avoid state: steps left to clear the obstacle and the step taken each loop
+ int avoid_steps = 0, avoid_x = 0, avoid_y = 0;
 
    // main loop
 while (true)   // main simulation loop
@@ -238,28 +266,37 @@ while (true)   // main simulation loop
         //Task 2
         previous_robot = robot;
         
-        // Incorporation of Task 4 navigation
-        if (robot.y != goal.y) {
-            if (robot.y < goal.y) {
-                robot.y += 1;
-            } else { // robot.y > goal.y
-                robot.y -= 1;
-            }
-        } else if (robot.x != goal.x) {
-            if (robot.x < goal.x) {
-                robot.x += 1;
-            } else { // robot.x > goal.x
-                robot.x -= 1;
+        // avoiding: one step off the obstacle per loop, back to the goal once clear
+        if (nav.state() == NAV_AVOID) {
+            robot.x += avoid_x;
+            robot.y += avoid_y;
+            if (--avoid_steps == 0) {
+                nav.fire(EV_CLEARED);
             }
         }
-        
-        // Check for collision after movement
-        if (is_collision(robot, grid)) {
-            // Determine which direction robot is moving when collision occurred
-            std::string collision_dir = get_collision_direction(robot, previous_robot);
+        else {
+            // Incorporation of Task 4 navigation: y first, then x, each leg an integer line. a new leg
+            // starts when the last one ended or avoidance moved the robot off it
+            if (motion.done() || motion.get_x() != robot.x || motion.get_y() != robot.y) {
+                if (robot.y != goal.y) {
+                    motion.start(robot.x, robot.y, robot.x, goal.y, max_speed);
+                } else {
+                    motion.start(robot.x, robot.y, goal.x, goal.y, max_speed);
+                }
+            }
+            motion.step(robot.x, robot.y);
             
-            // Perform obstacle avoidance
-            obstacle_avoidance(robot, collision_dir, grid, robot_pos, goal);
+            // Check for collision after movement
+            if (is_collision(robot, grid)) {
+                // Determine which direction robot is moving when collision occurred
+                collision_dir direction = get_collision_direction(robot, previous_robot);
+                
+                // Perform obstacle avoidance
+                avoid_steps = obstacle_avoidance(robot, direction, grid, goal, avoid_x, avoid_y);
+                if (avoid_steps > 0) {
+                    nav.fire(EV_COLLISION);
+                }
+            }
         }
         
         // Check if robot reached goal
@@ -267,6 +304,7 @@ while (true)   // main simulation loop
             robot.y < goal.y + goal.height && robot.y + robot.height > goal.y) {
             std::cout << "=====Goal reached! Mission successful.=====" << std::endl;
             succeed = true;
+            nav.fire(EV_REACHED);
             break;
         }
         
@@ -274,20 +312,25 @@ while (true)   // main simulation loop
         if (robot.x < 0 || robot.x >= width || robot.y < 0 || robot.y >= height) {
             std::cout << "=====Robot out of bounds! Mission failed.=====" << std::endl;
             succeed = false;
+            nav.fire(EV_LOST);
             break;
         }
 
         // place the current robot position at the time step to robot_pos
-        robot_pos.push_back({robot.x, robot.y});
+        robot_pos.push_back(robot.x, robot.y);
+        nav.tick();
         max_count++;
 
         // if more than a minute passed (in render window), exit
         if (max_count>=3600) {
             std::cout << "=====1 minute reached with no solution=====" << std::endl;
+            nav.fire(EV_LOST);
             break;
         }
     }
 
+    nav.print_profile(std::cout);
+
     // send the results of the code to the renderer
     render_window(robot_pos, objects, robot_init, goal_init, width, height, succeed);
     return 0;
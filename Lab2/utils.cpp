@@ -269,6 +269,57 @@ int grid_util::is_collision (Object robot) {
     return 0;
 }
 
+// precompute, for every cell, how many cells of value block_value follow it in a row along each
+// direction (0 if the cell itself is not blocking). call again whenever the grid changes
+void grid_util::build_runs(int block_value) {
+    for (int d = 0; d < 4; d++) {
+        runs[d] = std::vector<uint16_t>(env_width*env_height, 0);
+    }
+    for (int i = 0; i < env_width; i++) {
+        for (int j = 0; j < env_height; j++) {
+            // -x and -y runs from the cells before, +x and +y from the cells after
+            int ib = env_width - 1 - i;
+            int jb = env_height - 1 - j;
+            if (grid[i][j] == block_value) {
+                runs[1][i*env_height + j] = 1 + (i > 0 ? runs[1][(i-1)*env_height + j] : 0);
+                runs[3][i*env_height + j] = 1 + (j > 0 ? runs[3][i*env_height + j - 1] : 0);
+            }
+            if (grid[ib][jb] == block_value) {
+                runs[0][ib*env_height + jb] = 1 + (ib < env_width-1 ? runs[0][(ib+1)*env_height + jb] : 0);
+                runs[2][ib*env_height + jb] = 1 + (jb < env_height-1 ? runs[2][ib*env_height + jb + 1] : 0);
+            }
+        }
+    }
+}
+
+// how far the object must move along (dx, dy) (one of (+-1, 0), (0, +-1)) until none of its four
+// corners is on a blocking cell, the same corners is_collision checks. 0 if it is clear already,
+// -1 if it would leave the environment first. each pass jumps past the longest run under a corner,
+// so the answer takes a few lookups instead of a walk one pixel at a time
+int grid_util::clearance(const Object& obj, int dx, int dy) const {
+    const std::vector<uint16_t>& run = runs[dx > 0 ? 0 : dx < 0 ? 1 : dy > 0 ? 2 : 3];
+    int corner_x[2] = {obj.x, obj.x + obj.width - 1};
+    int corner_y[2] = {obj.y, obj.y + obj.height - 1};
+    int d = 0;
+    while (true) {
+        int jump = 0;
+        for (int cx: corner_x) {
+            for (int cy: corner_y) {
+                int x = cx + d*dx;
+                int y = cy + d*dy;
+                if (x < 0 || x >= env_width || y < 0 || y >= env_height) {
+                    return -1;
+                }
+                jump = std::max<int>(jump, run[x*env_height + y]);
+            }
+        }
+        if (jump == 0) {
+            return d;
+        }
+        d += jump;
+    }
+}
+
 // Function to write a nested vector (grid) to a CSV file. In case students want to analyze the grid as csv
 void grid_util::writeGridToCSV(const std::string& filename) {
     std::ofstream file(filename);
@@ -3,8 +3,10 @@
 #ifndef UTIL
 #define UTIL
 
+#include <cstdint>
 #include <random>
 #include <iostream>
+#include <vector>
 
 struct Object {
     int x, y, width, height;
@@ -24,6 +26,9 @@ class grid_util {
     // subgrids for making random spawns more efficient
     std::vector<std::vector<int>> subgrids;
     int num_subgrids, subgrids_size;
+    // lengths of the runs of blocking cells starting at each cell, flat x*env_height + y, one per
+    // direction (+x, -x, +y, -y). see build_runs()
+    std::vector<uint16_t> runs[4];
     public:
         // constructor
         grid_util(int, int, int, int);
@@ -35,6 +40,8 @@ class grid_util {
         bool is_occupied (int, int, int, int, int);
         int is_collision(Object);
         void writeGridToCSV(const std::string&);
+        void build_runs(int);
+        int clearance(const Object&, int, int) const;
 
         //Occupancy grid; outer vector represents rows, inner represents columns along each row, initialized to 0's
         std::vector<std::vector<int>> grid;
@@ -6,6 +6,7 @@
 #include <utility>
 #include "utils.h"
 #include "render.h"
+#include "trajectory.h"
 
 // my_robot sub-class
 // modify here so it inherits from the Object class from utils.h
@@ -170,7 +171,7 @@ grid_util grid(env_width, env_height, min_obj_size, max_obj_size);
 random_generator rand_gen;
 
 // Vector of velocity commands
-std::vector<std::vector<int>> robot_pos;
+trajectory robot_pos;
 
 int main(int argc, char const *argv[])
 {
@@ -201,7 +202,7 @@ int main(int argc, char const *argv[])
     my_robot robot_init = robot;
 
     // Push the initial position onto robot_pos
-    robot_pos.push_back({robot.x, robot.y});
+    robot_pos.push_back(robot.x, robot.y);
     int limit_count = 0;
     // Run the program indefinitely until robot hits the goal or an obstacle
     
@@ -227,7 +228,7 @@ int main(int argc, char const *argv[])
     // Move based on collision detection
     robot.move_based_on_collision(h, v);
     
-    robot_pos.push_back({robot.x, robot.y});
+    robot_pos.push_back(robot.x, robot.y);
     
     if (limit_count>=3600) {
         std::cout << "====Program terminated after 3600 iterations====" << std::endl;
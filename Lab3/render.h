@@ -3,6 +3,7 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include "utils.h"
+#include "trajectory.h"
 
 #ifndef RENDER
 #define RENDER
@@ -10,7 +11,7 @@
 sf::RectangleShape draw_object(int, int, int, int);
 
 void render_window(
-    std::vector<std::vector<int>>, 
+    const trajectory &, 
     std::vector<Object *>,
     Object, 
     int, 
@@ -18,7 +19,7 @@ void render_window(
 
 void render_grid(
     Object, 
-    std::vector<std::vector<int>>, 
+    const trajectory &, 
     std::vector<std::vector<int>>, 
     int, int, int, int);
 
@@ -0,0 +1,313 @@
+// boustrophedon coverage planner for sweeping the inside of the walls
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "coverage.h"
+#include "motion.h"
+
+// helper: 8-connected integer line from a to b, excluding a and including b
+static std::vector<std::pair<int, int>> line_pixels(std::pair<int, int> a, std::pair<int, int> b) {
+    std::vector<std::pair<int, int>> line;
+    line_motion motion(a.first, a.second, b.first, b.second);
+    int x, y;
+    while (motion.step(x, y)) {
+        line.push_back({x, y});
+    }
+    return line;
+}
+
+// constructor
+coverage_planner::coverage_planner(int width, int height, int spacing):
+    env_width(width),
+    env_height(height),
+    lane_spacing(spacing)
+{
+    reachable = std::vector<unsigned char>(env_width*env_height, 0);
+    parent = std::vector<int>(env_width*env_height, -1);
+}
+
+// flood fill (4-connected) the free space around the robot center (x, y). keeps the lanes
+// inside the walls even though the outside of the walls is free in the inflated layer.
+// returns false if the fill leaks to the edge of the grid, i.e. the mapped walls are not closed
+bool coverage_planner::find_reachable(const inflation_layer& layer, int x, int y) {
+    std::fill(reachable.begin(), reachable.end(), 0);
+    if (!layer.is_free(x, y)) {
+        return true;
+    }
+    std::vector<int> queue;
+    queue.reserve(env_width*env_height/4);
+    queue.push_back(x*env_height + y);
+    reachable[x*env_height + y] = 1;
+    const int dx[4] = {1, -1, 0, 0};
+    const int dy[4] = {0, 0, 1, -1};
+    for (size_t head = 0; head < queue.size(); head++) {
+        int i = queue[head] / env_height;
+        int j = queue[head] % env_height;
+        if (i == 0 || j == 0 || i == env_width-1 || j == env_height-1) {
+            return false;
+        }
+        for (int k = 0; k < 4; k++) {
+            int n_i = i + dx[k], n_j = j + dy[k];
+            if (layer.is_free(n_i, n_j) && !reachable[n_i*env_height + n_j]) {
+                reachable[n_i*env_height + n_j] = 1;
+                queue.push_back(n_i*env_height + n_j);
+            }
+        }
+    }
+    return true;
+}
+
+// closest free cell to (x, y) reachable without stepping on a wall (4-connected BFS)
+std::pair<int, int> coverage_planner::find_entry(const inflation_layer& layer, int x, int y) {
+    std::fill(parent.begin(), parent.end(), -1);
+    std::vector<int> queue;
+    queue.push_back(x*env_height + y);
+    parent[x*env_height + y] = queue[0];
+    const int dx[4] = {1, -1, 0, 0};
+    const int dy[4] = {0, 0, 1, -1};
+    for (size_t head = 0; head < queue.size(); head++) {
+        int i = queue[head] / env_height;
+        int j = queue[head] % env_height;
+        if (layer.is_free(i, j)) {
+            return {i, j};
+        }
+        for (int k = 0; k < 4; k++) {
+            int n_i = i + dx[k], n_j = j + dy[k];
+            if (!layer.is_occupied(n_i, n_j) && parent[n_i*env_height + n_j] < 0) {
+                parent[n_i*env_height + n_j] = queue[head];
+                queue.push_back(n_i*env_height + n_j);
+            }
+        }
+    }
+    return {x, y};
+}
+
+// split the reachable area into cells. an interval continues the cell above it only if the two
+// intervals overlap each other and nothing else; any split or merge starts a new cell
+std::vector<coverage_planner::cell> coverage_planner::decompose(int y_top, int y_bot) {
+    std::vector<cell> cells;
+    std::vector<int> lanes;
+    for (int y = y_top; y < y_bot; y += lane_spacing) {
+        lanes.push_back(y);
+    }
+    lanes.push_back(y_bot);
+
+    std::vector<std::pair<int, int>> prev, curr;   // intervals of the previous/current lane
+    std::vector<int> prev_cell, curr_cell;          // cell index of each interval
+    for (int y: lanes) {
+        // free intervals along this lane
+        curr.clear();
+        curr_cell.clear();
+        int start = -1;
+        for (int i = 0; i <= env_width; i++) {
+            bool free = (i < env_width) && reachable[i*env_height + y];
+            if (free && start < 0) {
+                start = i;
+            }
+            else if (!free && start >= 0) {
+                curr.push_back({start, i-1});
+                start = -1;
+            }
+        }
+        // match against the previous lane
+        for (size_t c = 0; c < curr.size(); c++) {
+            int matches = 0, match = -1;
+            for (size_t p = 0; p < prev.size(); p++) {
+                if (prev[p].first <= curr[c].second && curr[c].first <= prev[p].second) {
+                    matches++;
+                    match = p;
+                }
+            }
+            int back_matches = 0;
+            if (matches == 1) {
+                for (size_t k = 0; k < curr.size(); k++) {
+                    if (prev[match].first <= curr[k].second && curr[k].first <= prev[match].second) {
+                        back_matches++;
+                    }
+                }
+            }
+            if (matches == 1 && back_matches == 1) {
+                curr_cell.push_back(prev_cell[match]);
+            }
+            else {
+                cells.push_back(cell());
+                curr_cell.push_back(cells.size()-1);
+            }
+            cell &cl = cells[curr_cell.back()];
+            cl.y.push_back(y);
+            cl.x_l.push_back(curr[c].first);
+            cl.x_r.push_back(curr[c].second);
+        }
+        prev.swap(curr);
+        prev_cell.swap(curr_cell);
+    }
+    return cells;
+}
+
+// plan the sweep from the robot center (x, y). returns the lane end points (robot centers) in
+// visiting order; use connect() to expand each leg into pixel steps. the cells are visited in a
+// greedy order (closest cell corner next), which is short but not the shortest tour. returns no
+// waypoints if the walls around the robot are not fully mapped yet
+std::vector<std::pair<int, int>> coverage_planner::plan(const inflation_layer& layer, int x, int y) {
+    std::vector<std::pair<int, int>> waypoints;
+    // wall following can leave the robot inside the safety margin. start from the closest free
+    // cell, searching without crossing walls so the entry can't end up on the other side of one
+    if (!layer.is_free(x, y)) {
+        std::pair<int, int> entry = find_entry(layer, x, y);
+        x = entry.first;
+        y = entry.second;
+        waypoints.push_back(entry);
+    }
+    if (!find_reachable(layer, x, y)) {
+        std::cout << "Coverage planner: mapped walls are not closed around the robot" << std::endl;
+        this->num_cells = 0;
+        waypoints.clear();
+        return waypoints;
+    }
+
+    // vertical extent of the reachable area
+    int y_top = env_height, y_bot = -1;
+    for (int i = 0; i < env_width; i++) {
+        for (int j = 0; j < env_height; j++) {
+            if (reachable[i*env_height + j]) {
+                y_top = std::min(y_top, j);
+                y_bot = std::max(y_bot, j);
+            }
+        }
+    }
+    if (y_bot < 0) {
+        std::cerr << "Coverage planner: robot is not in free space" << std::endl;
+        this->num_cells = 0;
+        return waypoints;
+    }
+
+    std::vector<cell> cells = decompose(y_top, y_bot);
+    this->num_cells = cells.size();
+
+    // greedy tour, not an optimal one: always go to the closest unvisited cell corner (straight
+    // line distance), entering from the top or the bottom lane at either end, then sweep the cell
+    // back and forth
+    std::vector<bool> visited(cells.size(), false);
+    std::pair<int, int> pos{x, y};
+    for (size_t n = 0; n < cells.size(); n++) {
+        int best = -1;
+        bool best_top{true}, best_left{true};
+        double best_dist = 1e18;
+        for (size_t c = 0; c < cells.size(); c++) {
+            if (visited[c]) {
+                continue;
+            }
+            for (int top = 0; top < 2; top++) {
+                for (int left = 0; left < 2; left++) {
+                    int k = top ? 0 : cells[c].y.size()-1;
+                    int e_x = left ? cells[c].x_l[k] : cells[c].x_r[k];
+                    double dist = std::hypot(e_x - pos.first, cells[c].y[k] - pos.second);
+                    if (dist < best_dist) {
+                        best_dist = dist;
+                        best = c;
+                        best_top = top;
+                        best_left = left;
+                    }
+                }
+            }
+        }
+        visited[best] = true;
+        const cell &cl = cells[best];
+        int num_lanes = cl.y.size();
+        bool left_to_right = best_left;
+        for (int n_k = 0; n_k < num_lanes; n_k++) {
+            int k = best_top ? n_k : num_lanes-1-n_k;
+            if (left_to_right) {
+                waypoints.push_back({cl.x_l[k], cl.y[k]});
+                waypoints.push_back({cl.x_r[k], cl.y[k]});
+            }
+            else {
+                waypoints.push_back({cl.x_r[k], cl.y[k]});
+                waypoints.push_back({cl.x_l[k], cl.y[k]});
+            }
+            left_to_right = !left_to_right;
+        }
+        pos = waypoints.back();
+    }
+    return waypoints;
+}
+
+bool coverage_planner::line_is_free(const inflation_layer& layer, std::pair<int, int> a, std::pair<int, int> b) {
+    line_motion motion(a.first, a.second, b.first, b.second);
+    int x, y;
+    while (motion.step(x, y)) {
+        if (!layer.is_free(x, y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// pixel steps from a to b (excluding a, including b). straight line if it is free, otherwise the
+// shortest 8-connected path through the inflated layer. if a is inside the safety margin, the path
+// first steps out to the closest free cell without crossing a wall (see find_entry). empty if b
+// can't be reached
+std::vector<std::pair<int, int>> coverage_planner::connect(
+    const inflation_layer& layer, std::pair<int, int> a, std::pair<int, int> b)
+{
+    std::vector<std::pair<int, int>> path;
+    if (!layer.is_free(a.first, a.second)) {
+        std::pair<int, int> entry = find_entry(layer, a.first, a.second);
+        if (!layer.is_free(entry.first, entry.second)) {
+            return path;
+        }
+        // find_entry's parents lead back from the entry to a
+        int start = a.first*env_height + a.second;
+        for (int p = entry.first*env_height + entry.second; p != start; p = parent[p]) {
+            path.push_back({p / env_height, p % env_height});
+        }
+        std::reverse(path.begin(), path.end());
+        std::vector<std::pair<int, int>> rest = connect(layer, entry, b);
+        if (rest.empty() && entry != b) {
+            return rest;
+        }
+        path.insert(path.end(), rest.begin(), rest.end());
+        return path;
+    }
+    if (line_is_free(layer, a, b)) {
+        return line_pixels(a, b);
+    }
+    if (!layer.is_free(b.first, b.second)) {
+        return path;
+    }
+    std::fill(parent.begin(), parent.end(), -1);
+    int start = a.first*env_height + a.second;
+    int goal = b.first*env_height + b.second;
+    std::vector<int> queue;
+    queue.push_back(start);
+    parent[start] = start;
+    for (size_t head = 0; head < queue.size() && parent[goal] < 0; head++) {
+        int i = queue[head] / env_height;
+        int j = queue[head] % env_height;
+        for (int d_i = -1; d_i <= 1; d_i++) {
+            for (int d_j = -1; d_j <= 1; d_j++) {
+                int n_i = i + d_i, n_j = j + d_j;
+                if ((d_i || d_j) && layer.is_free(n_i, n_j) && parent[n_i*env_height + n_j] < 0) {
+                    parent[n_i*env_height + n_j] = queue[head];
+                    queue.push_back(n_i*env_height + n_j);
+                }
+            }
+        }
+    }
+    if (parent[goal] < 0) {
+        return path;
+    }
+    for (int p = goal; p != start; p = parent[p]) {
+        path.push_back({p / env_height, p % env_height});
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+int coverage_planner::get_num_cells() {
+    return this->num_cells;
+}
@@ -0,0 +1,35 @@
+// boustrophedon coverage planner for sweeping the inside of the walls
+// works on the robot's own grid (through its inflated layer), so it can run right after the lap
+#ifndef COVERAGE
+#define COVERAGE
+
+#include <utility>
+#include <vector>
+#include "utils.h"
+
+class coverage_planner {
+    int env_width, env_height;
+    int lane_spacing;                       // distance between sweep lanes, from the LiDAR footprint
+    int num_cells{0};
+    std::vector<unsigned char> reachable;   // free (inflated) cells connected to the robot
+    std::vector<int> parent;                // BFS parents for connect(), reused between calls
+    // a cell of the decomposition: one free interval [x_l, x_r] per lane it spans
+    struct cell {
+        std::vector<int> y, x_l, x_r;
+    };
+    private:
+        bool find_reachable(const inflation_layer&, int, int);
+        std::pair<int, int> find_entry(const inflation_layer&, int, int);
+        std::vector<cell> decompose(int, int);
+        bool line_is_free(const inflation_layer&, std::pair<int, int>, std::pair<int, int>);
+    public:
+        // constructor
+        coverage_planner(int, int, int);
+        // functions
+        std::vector<std::pair<int, int>> plan(const inflation_layer&, int, int);
+        std::vector<std::pair<int, int>> connect(const inflation_layer&, std::pair<int, int>, std::pair<int, int>);
+        // getters
+        int get_num_cells();
+};
+
+#endif
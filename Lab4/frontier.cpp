@@ -0,0 +1,278 @@
+// frontier based exploration
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "frontier.h"
+
+// constructor
+frontier_tracker::frontier_tracker(int width, int height, int lidar_range):
+    env_width(width),
+    env_height(height),
+    range(lidar_range)
+{
+    is_frontier = std::vector<unsigned char>(env_width*env_height, 0);
+    dist = std::vector<int>(env_width*env_height, -1);
+    parent = std::vector<int>(env_width*env_height, -1);
+    label = std::vector<int>(env_width*env_height, -1);
+    source = std::vector<int>(env_width*env_height, -1);
+}
+
+// a frontier cell is free or a wall with at least one unknown (-1) 4-neighbour
+bool frontier_tracker::check_cell(const std::vector<std::vector<int>>& grid, int i, int j) {
+    if (grid[i][j] == -1) {
+        return false;
+    }
+    return (i > 0 && grid[i-1][j] == -1) || (i < env_width-1 && grid[i+1][j] == -1)
+        || (j > 0 && grid[i][j-1] == -1) || (j < env_height-1 && grid[i][j+1] == -1);
+}
+
+// re-check the cells in [x_min, x_max] x [y_min, y_max] after they were mapped. their neighbours
+// can lose their unknown neighbour too, so the box is grown by one cell
+void frontier_tracker::update(const std::vector<std::vector<int>>& grid, int x_min, int y_min, int x_max, int y_max) {
+    x_min = std::max(x_min-1, 0);
+    y_min = std::max(y_min-1, 0);
+    x_max = std::min(x_max+1, env_width-1);
+    y_max = std::min(y_max+1, env_height-1);
+    for (int i = x_min; i <= x_max; i++) {
+        for (int j = y_min; j <= y_max; j++) {
+            bool frontier = check_cell(grid, i, j);
+            unsigned char &cell = is_frontier[i*env_height + j];
+            if (frontier && !cell) {
+                frontier_cells.push_back(i*env_height + j);
+                num_frontiers++;
+            }
+            else if (!frontier && cell) {
+                num_frontiers--;
+            }
+            cell = frontier;
+        }
+    }
+}
+
+// drop stale entries (cells that stopped being frontiers) from the list
+void frontier_tracker::compact() {
+    // a cell can be listed twice if it left and re-entered the frontier, so mark as we go
+    std::vector<int> cells;
+    cells.reserve(num_frontiers);
+    for (int c: frontier_cells) {
+        if (is_frontier[c] == 1) {
+            is_frontier[c] = 2;
+            cells.push_back(c);
+        }
+    }
+    for (int c: cells) {
+        is_frontier[c] = 1;
+    }
+    frontier_cells.swap(cells);
+}
+
+// 8-connected BFS from the robot center over cells that are free in the inflated layer. unknown
+// cells are free there, so paths are optimistic and get re-planned as walls show up. a robot
+// that starts inside the safety margin may move through it until it gets out
+void frontier_tracker::distance_field(const inflation_layer& layer, int x, int y) {
+    std::fill(dist.begin(), dist.end(), -1);
+    std::vector<int> queue;
+    queue.reserve(env_width*env_height/4);
+    queue.push_back(x*env_height + y);
+    dist[queue[0]] = 0;
+    parent[queue[0]] = queue[0];
+    for (size_t head = 0; head < queue.size(); head++) {
+        int i = queue[head] / env_height;
+        int j = queue[head] % env_height;
+        bool in_margin = !layer.is_free(i, j);
+        for (int d_i = -1; d_i <= 1; d_i++) {
+            for (int d_j = -1; d_j <= 1; d_j++) {
+                int n_i = i + d_i, n_j = j + d_j;
+                if (!(d_i || d_j) || n_i < 0 || n_i >= env_width || n_j < 0 || n_j >= env_height) {
+                    continue;
+                }
+                int n = n_i*env_height + n_j;
+                if (dist[n] >= 0) {
+                    continue;
+                }
+                if (layer.is_free(n_i, n_j) || (in_margin && !layer.is_occupied(n_i, n_j))) {
+                    dist[n] = dist[queue[head]] + 1;
+                    parent[n] = queue[head];
+                    queue.push_back(n);
+                }
+            }
+        }
+    }
+}
+
+// frontier cells along walls sit inside the safety margin. look for the closest reachable cell
+// without stepping on walls, so frontiers on the outside of a wall are not picked. -1 if none
+int frontier_tracker::find_entry(const inflation_layer& layer, int c) {
+    int max_depth = 4*layer.get_inflation();
+    std::vector<std::pair<int, int>> queue{{c, 0}};
+    std::set<int> seen{c};
+    const int dx[4] = {1, -1, 0, 0};
+    const int dy[4] = {0, 0, 1, -1};
+    for (size_t head = 0; head < queue.size(); head++) {
+        int cell = queue[head].first;
+        if (dist[cell] > 0) {
+            return cell;
+        }
+        if (queue[head].second >= max_depth) {
+            continue;
+        }
+        int i = cell / env_height;
+        int j = cell % env_height;
+        for (int k = 0; k < 4; k++) {
+            int n_i = i + dx[k], n_j = j + dy[k];
+            if (n_i < 0 || n_i >= env_width || n_j < 0 || n_j >= env_height) {
+                continue;
+            }
+            int n = n_i*env_height + n_j;
+            if (!layer.is_occupied(n_i, n_j) && seen.insert(n).second) {
+                queue.push_back({n, queue[head].second + 1});
+            }
+        }
+    }
+    return -1;
+}
+
+// wall frontier cells can't be driven to. look for a reachable cell within LiDAR range of one of
+// them (so within range of its unknown neighbour too): the scan from there maps that neighbour.
+// each search cell keeps the wall cell it was reached from, so the range is exact. of those, take
+// the one with the shortest drive plus distance to its wall cell: right up against the wall on the
+// way to it, so each trip maps as much of the wall as it can. cells under range/4 steps away only
+// if there is nothing further: driving along a wall, the next unmapped wall cells are a step
+// ahead, and a full re-plan every step is slow. -1 if none
+int frontier_tracker::find_lookout(const inflation_layer& layer, const std::vector<int>& walls) {
+    int max_dist_sq = (range - 1)*(range - 1);
+    std::vector<int> queue(walls);
+    for (int c: walls) {
+        source[c] = c;
+    }
+    const int dx[4] = {1, -1, 0, 0};
+    const int dy[4] = {0, 0, 1, -1};
+    int best = -1;
+    bool best_near = false;
+    double best_cost = 0.0;
+    for (size_t head = 0; head < queue.size(); head++) {
+        int cell = queue[head];
+        int i = cell / env_height;
+        int j = cell % env_height;
+        int s_i = source[cell] / env_height;
+        int s_j = source[cell] % env_height;
+        if (dist[cell] > 0) {
+            bool near = dist[cell] < range/4;
+            double cost = dist[cell] + std::sqrt((i - s_i)*(i - s_i) + (j - s_j)*(j - s_j));
+            if (best < 0 || (best_near && !near) || (near == best_near && cost < best_cost)) {
+                best = cell;
+                best_near = near;
+                best_cost = cost;
+            }
+        }
+        for (int k = 0; k < 4; k++) {
+            int n_i = i + dx[k], n_j = j + dy[k];
+            if (n_i < 0 || n_i >= env_width || n_j < 0 || n_j >= env_height) {
+                continue;
+            }
+            int n = n_i*env_height + n_j;
+            if (source[n] < 0 && (n_i - s_i)*(n_i - s_i) + (n_j - s_j)*(n_j - s_j) <= max_dist_sq) {
+                source[n] = source[cell];
+                queue.push_back(n);
+            }
+        }
+    }
+    // reset for the next search
+    for (int c: queue) {
+        source[c] = -1;
+    }
+    return best;
+}
+
+// choose the frontier cluster with the best information gain (cluster size) per distance and return
+// the path (robot centers, excluding (x, y)) to it. empty once no reachable frontier is left
+std::vector<std::pair<int, int>> frontier_tracker::plan(const inflation_layer& layer, int x, int y) {
+    std::vector<std::pair<int, int>> path;
+    compact();
+    distance_field(layer, x, y);
+
+    // label 8-connected clusters, keeping the closest reachable cell of each. labels are all -1
+    // between calls
+    num_clusters = 0;
+    int best_target{-1};
+    double best_score = 0.0;
+    std::vector<int> queue;
+    for (int c: frontier_cells) {
+        if (label[c] >= 0) {
+            continue;
+        }
+        int l = num_clusters++;
+        int size = 0, target = -1, target_dist = -1;
+        // free and wall frontiers are clustered apart, or a wall would join all the frontiers along
+        // it into one target
+        bool wall = layer.is_occupied(c / env_height, c % env_height);
+        queue.clear();
+        queue.push_back(c);
+        label[c] = l;
+        for (size_t head = 0; head < queue.size(); head++) {
+            int cell = queue[head];
+            size++;
+            // a frontier the robot is already on can't be cleared by driving to it
+            if (dist[cell] > 0 && (target < 0 || dist[cell] < target_dist)) {
+                target = cell;
+                target_dist = dist[cell];
+            }
+            int i = cell / env_height;
+            int j = cell % env_height;
+            for (int d_i = -1; d_i <= 1; d_i++) {
+                for (int d_j = -1; d_j <= 1; d_j++) {
+                    int n_i = i + d_i, n_j = j + d_j;
+                    if (n_i < 0 || n_i >= env_width || n_j < 0 || n_j >= env_height) {
+                        continue;
+                    }
+                    int n = n_i*env_height + n_j;
+                    if (is_frontier[n] && label[n] < 0 && layer.is_occupied(n_i, n_j) == wall) {
+                        label[n] = l;
+                        queue.push_back(n);
+                    }
+                }
+            }
+        }
+        // no cell of the cluster is reachable (always the case for walls): try to get within range of
+        // its walls, or next to its middle
+        if (target < 0) {
+            target = wall ? find_lookout(layer, queue) : find_entry(layer, queue[queue.size()/2]);
+        }
+        if (target < 0) {
+            continue;
+        }
+        target_dist = dist[target];
+        double score = static_cast<double>(size) / (target_dist + 1);
+        if (target_dist > 0 && score > best_score) {
+            best_score = score;
+            best_target = target;
+        }
+    }
+    // reset labels for the next call
+    for (int c: frontier_cells) {
+        label[c] = -1;
+    }
+
+    if (best_target < 0) {
+        return path;
+    }
+    int start = x*env_height + y;
+    for (int p = best_target; p != start; p = parent[p]) {
+        path.push_back({p / env_height, p % env_height});
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+int frontier_tracker::get_num_frontiers() {
+    return this->num_frontiers;
+}
+
+int frontier_tracker::get_num_clusters() {
+    return this->num_clusters;
+}
@@ -0,0 +1,38 @@
+// frontier based exploration: drive towards the boundary between known free space and unknown cells
+// frontiers are tracked incrementally as the robot maps, then clustered when a new target is needed.
+// mapped wall cells next to unknown ones count too: the far side of a thick wall is only seen from
+// close by, and nothing else leads the robot there
+#ifndef FRONTIER
+#define FRONTIER
+
+#include <utility>
+#include <vector>
+#include "utils.h"
+
+class frontier_tracker {
+    int env_width, env_height, range;
+    std::vector<unsigned char> is_frontier;     // 1 for free or wall cells next to an unknown cell
+    std::vector<int> frontier_cells;            // indices of frontier cells. stale entries removed lazily
+    int num_frontiers{0}, num_clusters{0};
+    std::vector<int> dist;                      // BFS distance (steps) from the robot, -1 if unreachable
+    std::vector<int> parent;                    // BFS parents, for the path to the chosen target
+    std::vector<int> label;                     // cluster label of each frontier cell
+    std::vector<int> source;                    // wall cell each lookout search cell was reached from
+    private:
+        bool check_cell(const std::vector<std::vector<int>>&, int, int);
+        void compact();
+        void distance_field(const inflation_layer&, int, int);
+        int find_entry(const inflation_layer&, int);
+        int find_lookout(const inflation_layer&, const std::vector<int>&);
+    public:
+        // constructor
+        frontier_tracker(int, int, int);
+        // functions
+        void update(const std::vector<std::vector<int>>&, int, int, int, int);
+        std::vector<std::pair<int, int>> plan(const inflation_layer&, int, int);
+        // getters
+        int get_num_frontiers();
+        int get_num_clusters();
+};
+
+#endif
@@ -6,10 +6,53 @@
 #include <utility>
 #include <iomanip>
 #include <array>
-#include <queue>
+#include <thread>
 
 #include "utils.h"
 #include "render.h"
+#include "trajectory.h"
+#include "coverage.h"
+#include "frontier.h"
+#include "logger.h"
+#include "live.h"
+#include "nav_machine.h"
+#include "wall_probe.h"
+#include "path_ring.h"
+#include "team.h"
+#include "map_merge.h"
+
+// controller states and the events that move between them, see nav_machine.h
+enum nav_state : uint8_t {
+    NAV_LAP,                            // following the walls for the first lap
+    NAV_RETURN_TO_TOP,                  // reactive sweep: following the walls back up to min_y
+    NAV_SWEEP,                          // reactive sweep
+    NAV_COVERAGE,                       // following the coverage planner's path
+    NAV_FRONTIER,                       // frontier exploration
+    NAV_DONE,
+    NUM_NAV_STATES
+};
+
+enum nav_event : uint8_t {
+    EV_LAPPED_SWEEP,                    // lap done, sweep reactively
+    EV_LAPPED_COVERAGE,                 // lap done, coverage path planned
+    EV_AT_TOP,                          // back at min_y
+    EV_START_FRONTIER,
+    EV_FINISHED,
+    NUM_NAV_EVENTS
+};
+
+const char *const nav_state_names[NUM_NAV_STATES] = {"lap", "return to top", "sweep", "coverage", "frontier", "done"};
+
+const uint8_t STAY = nav_machine::stay;
+const uint8_t nav_table[NUM_NAV_STATES][NUM_NAV_EVENTS] = {
+    //                LAPPED_SWEEP       LAPPED_COVERAGE  AT_TOP     START_FRONTIER  FINISHED
+    /* lap */        {NAV_RETURN_TO_TOP, NAV_COVERAGE,    STAY,      NAV_FRONTIER,   NAV_DONE},
+    /* return */     {STAY,              STAY,            NAV_SWEEP, STAY,           NAV_DONE},
+    /* sweep */      {STAY,              STAY,            STAY,      STAY,           NAV_DONE},
+    /* coverage */   {STAY,              STAY,            STAY,      STAY,           NAV_DONE},
+    /* frontier */   {STAY,              STAY,            STAY,      STAY,           NAV_DONE},
+    /* done */       {STAY,              STAY,            STAY,      STAY,           STAY}
+};
 
 // my_robot sub-class
 // modify here so it inherits from the Object class from utils.h
@@ -17,28 +60,51 @@ class my_robot : public Object {
 private:     // define any private or protected members here
     int environment_type; // For collision avoidance for env 1 and 3
     int range;
-    std::array<int, 4> prev_mode{0, 0, 0, 0};
-    std::queue<std::pair<int, int>> paths_queue;
+    uint8_t prev_mode{0};               // wall masks, see wall_probe.h
+    // steps the wall follower committed to, see move(). while path_steady the wall mask at each of
+    // them is known to be prev_mode, so detect_walls needn't probe until the ring runs out
+    path_ring<32> paths_queue;
+    bool path_steady = false;
+    int path_x = -1, path_y = -1;       // where the robot should be when the next step is taken
+    std::pair<int, int> path_vec{0, 0}; // wall vector the steps were planned for
+    std::array<int, 4> path_box{0, 0, -1, -1};  // cells the probes read along the steps
+    wall_runs runs;                     // wall run lengths of grid, for planning the steps
+    // forget the committed steps
+    void drop_path() {
+        paths_queue.clear();
+        path_steady = false;
+        path_box = {0, 0, -1, -1};
+    }
     bool clockwise = true;
-    static constexpr double sin45 = 0.70710678118;
     int tol_distance;
+    wall_probe probe;
     static const int radius = 10;
     
     // Task 2: Member variables for sweep algorithm
-    bool sweep_mode = false;
     int min_y_tracked = 800;
     int max_y_tracked = 0;
     int y_ref = 0;
     int start_x = -1;
     int start_y = -1;
     bool lapped_walls = false;
-    std::array<int, 4> mode_before_move{0, 0, 0, 0};
-    bool returning_to_top = false;
+    uint8_t mode_before_move{0};
     int lap_counter = 0;
 
+    // Task 2: planned sweep. lane end points from the coverage planner, expanded one leg at a time
+    std::vector<std::pair<int, int>> coverage_waypoints;
+    size_t waypoint_index = 0;
+    std::vector<std::pair<int, int>> segment;   // pixel steps (robot centers) to the current waypoint
+    size_t segment_index = 0;
+
+    // frontier exploration: cells revealed by the last map_environment and the path to the target
+    std::array<int, 4> revealed_box{0, 0, -1, -1};
+    std::vector<std::pair<int, int>> frontier_path;
+    size_t frontier_index = 0;
+
 public:
-my_robot(int width, int height, int env_width, int min_y, int max_y, int tol, int lidar_range, int env_type = 4) 
-        : Object(width, height, env_width, min_y, max_y, tol), range(lidar_range), environment_type(env_type) {
+my_robot(int width, int height, int env_width, int min_y, int max_y, int tol, int lidar_range, int env_type = 4, int margin = 0) 
+        : Object(width, height, env_width, min_y, max_y, tol), environment_type(env_type), range(lidar_range),
+          runs(800, 800), inflated(800, 800, radius, margin) {
         grid = std::vector<std::vector<int>>(800, std::vector<int>(800, -1));
         
         // Adaptive tolerance
@@ -51,16 +117,24 @@ my_robot(int width, int height, int env_width, int min_y, int max_y, int tol, in
         else {
             tol_distance = radius + 7;
         }
+        probe = wall_probe(tol_distance);
     }
     
     std::vector<std::vector<int>> grid;
-    
+    // walls of the known grid dilated by the robot footprint + safety margin, updated in map_environment
+    inflation_layer inflated;
+    // live view: map_environment publishes every cell it changes, nullptr when off
+    live_channel *live{nullptr};
+    // team mode: the tiles this robot mapped since it last merged into the team map
+    tile_tracker tiles{800, 800};
+    // which part of the controller runs (lap, sweep, coverage, ...), with per state profiling
+    nav_machine nav{&nav_table[0][0], nav_state_names, NUM_NAV_STATES, NUM_NAV_EVENTS, NAV_LAP};
     
     // Task 1: Function declarations
     void map_environment(grid_util& true_grid);
-    std::array<int, 4> detect_walls();
-    std::pair<int, int> calculate_wall_vec(std::array<int, 4> mode);
-    std::pair<int, int> find_dir(std::array<int, 4> mode_curr);
+    uint8_t detect_walls();
+    std::pair<int, int> calculate_wall_vec(uint8_t mode);
+    std::pair<int, int> find_dir(uint8_t mode_curr);
     void move(std::pair<int, int> robot_to_wall);
     void save_grid_csv();
     
@@ -68,18 +142,28 @@ my_robot(int width, int height, int env_width, int min_y, int max_y, int tol, in
     void update_min_max_y();
     bool check_if_lapped();
     void toggle_direction();
+    bool is_clockwise() { return clockwise; }
     bool is_free_of_walls();
     void move_away_from_wall_once();
-    bool in_sweep_mode() { return sweep_mode; }
+    bool in_sweep_mode() { return nav.state() == NAV_RETURN_TO_TOP || nav.state() == NAV_SWEEP; }
     void start_sweep_mode();
     int get_max_y() { return max_y_tracked; }
     int get_min_y() { return min_y_tracked; }
     int get_y_ref() { return y_ref; }
     void update_y_ref() { y_ref = this->y + radius; }
-    std::array<int, 4> get_mode_before_move() { return mode_before_move; }
-    void store_mode_before_move(std::array<int, 4> mode) { mode_before_move = mode; }
-    bool is_returning_to_top() { return returning_to_top; }
-    void set_returning_to_top(bool val) { returning_to_top = val; }
+    uint8_t get_mode_before_move() { return mode_before_move; }
+    void store_mode_before_move(uint8_t mode) { mode_before_move = mode; }
+    bool is_returning_to_top() { return nav.state() == NAV_RETURN_TO_TOP; }
+    void reached_top() { nav.fire(EV_AT_TOP); }
+    void restart_lap() { start_x = -1; start_y = -1; }
+    bool start_coverage_mode(coverage_planner& planner);
+    bool in_coverage_mode() { return nav.state() == NAV_COVERAGE; }
+    bool follow_coverage_path(coverage_planner& planner);
+    bool follow_frontiers(frontier_tracker& frontiers);
+    // team mode
+    void yield_step(int prev_x, int prev_y);
+    void replan_around(const std::vector<std::pair<int, int>>& others, frontier_tracker& frontiers);
+    int pull_team_map(const shared_map& team_map, frontier_tracker& frontiers);
 };
 
         void save_grid_csv() {
@@ -101,160 +185,66 @@ void my_robot::map_environment(grid_util& true_grid) {
         return;
     }
     
+    // bounding box of cells that became (or stopped being) walls, for the inflated layer
+    int x_min = 800, y_min = 800, x_max = -1, y_max = -1;
+    // bounding box of cells that were unknown until now, for the frontiers
+    revealed_box = {800, 800, -1, -1};
     for (int i = center_x - range; i <= center_x + range; i++) {
         for (int j = center_y - range; j <= center_y + range; j++) {
             if (i >= 0 && i < 800 && j >= 0 && j < 800) {
                 if ((i - center_x)*(i - center_x) + (j - center_y)*(j - center_y) <= range*range) {
                     int true_value = Object::grid_value(true_grid, this, i, j, range);
                     if (true_value != -1) {
+                        if (grid[i][j] == -1) {
+                            tiles.touch(i, j);
+                            revealed_box = {std::min(revealed_box[0], i), std::min(revealed_box[1], j),
+                                std::max(revealed_box[2], i), std::max(revealed_box[3], j)};
+                        }
+                        if ((grid[i][j] >= 1) != (true_value >= 1)) {
+                            x_min = std::min(x_min, i);
+                            y_min = std::min(y_min, j);
+                            x_max = std::max(x_max, i);
+                            y_max = std::max(y_max, j);
+                        }
+                        if (live != nullptr && grid[i][j] != true_value) {
+                            live->publish_cell(i, j, true_value);
+                        }
                         grid[i][j] = true_value;
                     }
                 }
             }
         }
     }
-}
-// Task 1: Wall detection
-std::array<int, 4> my_robot::detect_walls() {
-    std::array<int, 4> mode{0, 0, 0, 0};
-    int c_x = this->x + radius;
-    int c_y = this->y + radius;
-    int tol = tol_distance;
-    int tol_45 = static_cast<int>(tol * sin45);
-    
-// Check horizontal sides (x)
-bool right_wall_detected = false;
-bool left_wall_detected = false;
-
-// Check multiple points along the horizontal axis for better detection
-for (int offset = -3; offset <= 3; offset += 3) {
-    // Check right side with multiple points
-    if (c_x + tol < 800 && c_y + offset >= 0 && c_y + offset < 800 && 
-        grid[c_x + tol][c_y + offset] == 1) {
-        right_wall_detected = true;
-    }
-    // Check left side with multiple points  
-    if (c_x - tol >= 0 && c_y + offset >= 0 && c_y + offset < 800 && 
-        grid[c_x - tol][c_y + offset] == 1) {
-        left_wall_detected = true;
-    }
-}
-
-// Set mode based on detection
-if (right_wall_detected) {
-    mode[0] = 1; // right
-} else if (left_wall_detected) {
-    mode[0] = -1; // left
-} else {
-    mode[0] = 0; // no horizontal wall
-}
-    
-    // Check vertical sides (y)
-    if (c_x >= 0 && c_x < 800 && c_y + tol < 800 && grid[c_x][c_y + tol] == 1) {
-        mode[1] = 1; // bottom
-    }
-    else if (c_x >= 0 && c_x < 800 && c_y - tol >= 0 && grid[c_x][c_y - tol] == 1) {
-        mode[1] = -1; // top
-    }
-    
-// Check diagonal sides (v)
-bool bottom_right_detected = false;
-bool top_left_detected = false;
-
-for (int offset = -3; offset <= 3; offset += 3) {
-    // Check bottom-right diagonal with multiple points
-    if (c_x + tol_45 + offset < 800 && c_y + tol_45 + offset >= 0 && c_y + tol_45 + offset < 800 && 
-        grid[c_x + tol_45 + offset][c_y + tol_45 + offset] == 1) {
-        bottom_right_detected = true;
-    }
-    // Check top-left diagonal with multiple points
-    if (c_x - tol_45 + offset >= 0 && c_y - tol_45 + offset >= 0 && c_y - tol_45 + offset < 800 && 
-        grid[c_x - tol_45 + offset][c_y - tol_45 + offset] == 1) {
-        top_left_detected = true;
+    // most steps only reveal free space, so the layer is rarely touched. new walls where the
+    // probes read void the steps planned from the old map
+    if (x_max >= 0) {
+        inflated.update(grid, x_min, y_min, x_max, y_max);
+        runs.update(grid, x_min, y_min, x_max, y_max);
+        if (x_min <= path_box[2] && x_max >= path_box[0] && y_min <= path_box[3] && y_max >= path_box[1]) {
+            drop_path();
+        }
     }
 }
-
-if (bottom_right_detected) {
-    mode[2] = 1; // bottom right
-} else if (top_left_detected) {
-    mode[2] = -1; // top left
-} else {
-    mode[2] = 0;
-}
-
-// Check diagonal sides (w) 
-bool top_right_detected = false;
-bool bottom_left_detected = false;
-
-for (int offset = -3; offset <= 3; offset += 3) {
-    // Check top-right diagonal with multiple points
-    if (c_x + tol_45 + offset < 800 && c_y - tol_45 + offset >= 0 && c_y - tol_45 + offset < 800 && 
-        grid[c_x + tol_45 + offset][c_y - tol_45 + offset] == 1) {
-        top_right_detected = true;
+// Task 1: Wall detection. bit mask of the walls around the robot, see wall_probe.h
+uint8_t my_robot::detect_walls() {
+    // on a committed step the mask is the one the steps were planned with
+    if (path_steady && this->x == path_x && this->y == path_y) {
+        return prev_mode;
     }
-    // Check bottom-left diagonal with multiple points
-    if (c_x - tol_45 + offset >= 0 && c_y + tol_45 + offset >= 0 && c_y + tol_45 + offset < 800 && 
-        grid[c_x - tol_45 + offset][c_y + tol_45 + offset] == 1) {
-        bottom_left_detected = true;
-    }
-}
-
-if (top_right_detected) {
-    mode[3] = 1; // top right
-} else if (bottom_left_detected) {
-    mode[3] = -1; // bottom left
-} else {
-    mode[3] = 0;
-}
-    
-    return mode;
+    return probe.sense(grid, this->x + radius, this->y + radius);
 }
 
-std::pair<int, int> my_robot::calculate_wall_vec(std::array<int, 4> mode) {
-    int xw = 0, yw = 0;
-    
-    // Count current and previous wall hits for Table 2 logic from lab manual
-    int current_hits = 0;
-    int prev_hits = 0;
-    for(int i = 0; i < 4; i++) {
-        if(mode[i] != 0) current_hits++;
-        if(prev_mode[i] != 0) prev_hits++;
-    }
-    
-    // Table 2 implentation
-    if(prev_hits == 0 && current_hits == 0) {
-        return {0, 1};
-    }
-    else if(prev_hits <= 1 && current_hits >= 1) {
-        // Derived from array: Mode_curr - Mode_prev
-        for(int i = 0; i < 4; i++) {
-            if(mode[i] != 0) {
-                if(i == 0) xw += mode[i]; // x
-                else if(i == 1) yw += mode[i]; // y
-                else if(i == 2) { xw += mode[i]; yw += mode[i]; } // v
-                else if(i == 3) { xw += mode[i]; yw -= mode[i]; } // w
-            }
-        }
-    }
-    else if(prev_hits >= 2 && current_hits >= 1) {
-        // Derived from Mode_curr
-        for(int i = 0; i < 4; i++) {
-            if(mode[i] != 0) {
-                if(i == 0) xw += mode[i]; // x
-                else if(i == 1) yw += mode[i]; // y
-                else if(i == 2) { xw += mode[i]; yw += mode[i]; } // v
-                else if(i == 3) { xw += mode[i]; yw -= mode[i]; } // w
-            }
+std::pair<int, int> my_robot::calculate_wall_vec(uint8_t mode) {
+    const wall_entry& current = wall_probe::lookup(mode);
+    // Table 2 from lab manual: with no wall now, go down if there was none before either, else stop.
+    // otherwise the wall vector is derived from Mode_curr, precomputed for every mask
+    if (current.hits == 0) {
+        if (wall_probe::lookup(prev_mode).hits == 0) {
+            return {0, 1};
         }
+        return {0, 0};
     }
-    
-    // Normalize to -1, 0, or 1
-    if(xw > 0) xw = 1;
-    else if(xw < 0) xw = -1;
-    if(yw > 0) yw = 1;
-    else if(yw < 0) yw = -1;
-    
-    return {xw, yw};
+    return {current.xw, current.yw};
 }
 
 void my_robot::move(std::pair<int, int> robot_to_wall) {
@@ -298,52 +288,75 @@ void my_robot::move(std::pair<int, int> robot_to_wall) {
         }
     }
     
-    // Queue system
+    // Queue system. committed steps are dropped if the robot was moved some other way
+    if(!paths_queue.empty() && (this->x != path_x || this->y != path_y || robot_to_wall != path_vec)) {
+        drop_path();
+    }
     if(paths_queue.empty()) {
-        const int n = 1;
-        for(int i = 1; i <= n; i++) {
-            int new_x = this->x + x_dir * i;
-            int new_y = this->y + y_dir * i;
-            
-            // Adaptive bounds checking - Use environment boundaries
-            int min_bound = radius + 10;
-            int max_bound_x = 800 - radius;
-            int max_bound_y = 800 - radius;
-            
-            // Ensure robot center stays within bounds
-            int center_x = new_x + radius;
-            int center_y = new_y + radius;
-            
-            if(center_x < min_bound) new_x = min_bound - radius;
-            if(center_x > max_bound_x) new_x = max_bound_x - radius;
-            if(center_y < min_bound) new_y = min_bound - radius;
-            if(center_y > max_bound_y) new_y = max_bound_y - radius;
-            
-            paths_queue.push({new_x, new_y});
+        int new_x = this->x + x_dir;
+        int new_y = this->y + y_dir;
+        
+        // Adaptive bounds checking - Use environment boundaries
+        int min_bound = radius + 10;
+        int max_bound_x = 800 - radius;
+        int max_bound_y = 800 - radius;
+        
+        // Ensure robot center stays within bounds
+        int center_x = new_x + radius;
+        int center_y = new_y + radius;
+        
+        if(center_x < min_bound) new_x = min_bound - radius;
+        if(center_x > max_bound_x) new_x = max_bound_x - radius;
+        if(center_y < min_bound) new_y = min_bound - radius;
+        if(center_y > max_bound_y) new_y = max_bound_y - radius;
+        
+        paths_queue.push(new_x, new_y);
+        path_x = this->x;
+        path_y = this->y;
+        path_vec = robot_to_wall;
+        path_steady = false;
+        
+        // while the mask stays prev_mode, find_dir keeps returning calculate_wall_vec(prev_mode). if
+        // that is this step's vector, commit to the steps along it that the wall runs guarantee
+        if(new_x == this->x + x_dir && new_y == this->y + y_dir && calculate_wall_vec(prev_mode) == robot_to_wall) {
+            int steps = probe.steady_steps(grid, runs, this->x + radius, this->y + radius, prev_mode, x_dir, y_dir,
+                paths_queue.capacity());
+            // and stop short of the bounds clamp
+            if(x_dir > 0) steps = std::min(steps, max_bound_x - (this->x + radius));
+            if(x_dir < 0) steps = std::min(steps, (this->x + radius) - min_bound);
+            if(y_dir > 0) steps = std::min(steps, max_bound_y - (this->y + radius));
+            if(y_dir < 0) steps = std::min(steps, (this->y + radius) - min_bound);
+            if(steps >= 1) {
+                path_steady = true;
+                int reach = probe.get_reach();
+                int end_x = this->x + radius + x_dir * steps, end_y = this->y + radius + y_dir * steps;
+                path_box = {std::min(this->x + radius, end_x) - reach, std::min(this->y + radius, end_y) - reach,
+                    std::max(this->x + radius, end_x) + reach, std::max(this->y + radius, end_y) + reach};
+                for(int i = 2; i <= steps; i++) {
+                    paths_queue.push(this->x + x_dir * i, this->y + y_dir * i);
+                }
+            }
         }
     }
     
     // Move to next position in queue
-    if(!paths_queue.empty()) {
-        std::pair<int, int> next_pos = paths_queue.front();
-        paths_queue.pop();
-        
-        // Final safety check
-        int center_x = next_pos.first + radius;
-        int center_y = next_pos.second + radius;
-        if(center_x >= 0 && center_x < 800 && center_y >= 0 && center_y < 800) {
-            this->x = next_pos.first;
-            this->y = next_pos.second;
-        }
+    traj_point next_pos = paths_queue.pop();
+    
+    // Final safety check
+    int center_x = next_pos.x + radius;
+    int center_y = next_pos.y + radius;
+    if(center_x >= 0 && center_x < 800 && center_y >= 0 && center_y < 800) {
+        this->x = next_pos.x;
+        this->y = next_pos.y;
     }
+    path_x = this->x;
+    path_y = this->y;
 }
 
-std::pair<int, int> my_robot::find_dir(std::array<int, 4> mode_curr) {
+std::pair<int, int> my_robot::find_dir(uint8_t mode_curr) {
     if(mode_curr != prev_mode) {
         // Clear paths_queue
-        while(!paths_queue.empty()) {
-            paths_queue.pop();
-        }
+        drop_path();
         
         // Calculate new wall vector
         std::pair<int, int> wall_vec = calculate_wall_vec(mode_curr);
@@ -358,6 +371,48 @@ std::pair<int, int> my_robot::find_dir(std::array<int, 4> mode_curr) {
     return calculate_wall_vec(prev_mode);
 }
 
+// team mode: another robot is in the way, take this step again next time
+void my_robot::yield_step(int prev_x, int prev_y) {
+    this->x = prev_x;
+    this->y = prev_y;
+    if (frontier_index > 0) {
+        frontier_index--;
+    }
+}
+
+// team mode: re-plan with the other robots (top left corners) as obstacles. they aren't mapped,
+// so they only block this plan; the layer is restored from the map right after
+void my_robot::replan_around(const std::vector<std::pair<int, int>>& others, frontier_tracker& frontiers) {
+    // centers closer than two radii overlap
+    int r = 2*radius;
+    for (const std::pair<int, int>& other: others) {
+        inflated.block_disc(other.first + radius, other.second + radius, r);
+    }
+    frontier_path = frontiers.plan(inflated, this->x + radius, this->y + radius);
+    frontier_index = 0;
+    for (const std::pair<int, int>& other: others) {
+        inflated.update(grid, other.first + radius - r, other.second + radius - r, other.first + radius + r,
+            other.second + radius + r);
+    }
+}
+
+// team mode: copy in what the rest of the team has mapped. only unknown cells are filled, and the
+// team only maps true values, so this is as if the robot had scanned them. returns the tiles filled
+int my_robot::pull_team_map(const shared_map& team_map, frontier_tracker& frontiers) {
+    std::array<int, 4> wall_box{800, 800, -1, -1};
+    std::vector<int> filled = tiles.pull(team_map, grid, wall_box);
+    if (wall_box[2] >= 0) {
+        inflated.update(grid, wall_box[0], wall_box[1], wall_box[2], wall_box[3]);
+        runs.update(grid, wall_box[0], wall_box[1], wall_box[2], wall_box[3]);
+        drop_path();
+    }
+    for (int t: filled) {
+        std::array<int, 4> box = team_map.tile_box(t);
+        frontiers.update(grid, box[0], box[1], box[2] - 1, box[3] - 1);
+    }
+    return filled.size();
+}
+
 // function to save predicted grid
 void my_robot::save_grid_csv() {
     std::string filename = "grid_pred.csv";
@@ -407,15 +462,7 @@ void my_robot::update_min_max_y() {
 bool my_robot::check_if_lapped() {
     // Record start position when first hitting a wall
     if (start_x == -1 && start_y == -1) {
-        std::array<int, 4> current_mode = detect_walls();
-        bool hit_wall = false;
-        for (int i = 0; i < 4; i++) {
-            if (current_mode[i] != 0) {
-                hit_wall = true;
-                break;
-            }
-        }
-        if (hit_wall) {
+        if (detect_walls() != 0) {
             start_x = this->x;
             start_y = this->y;
             lap_counter = 0;
@@ -447,24 +494,17 @@ bool my_robot::check_if_lapped() {
 void my_robot::toggle_direction() {
     clockwise = !clockwise;
     // Clear paths queue when direction changes
-    while (!paths_queue.empty()) {
-        paths_queue.pop();
-    }
+    drop_path();
 }
 
 // Task 2: Check if robot is free of all walls
 bool my_robot::is_free_of_walls() {
-    std::array<int, 4> mode = detect_walls();
-    for (int i = 0; i < 4; i++) {
-        if (mode[i] != 0) {
-            return false;
-        }
-    }
-    return true;
+    return detect_walls() == 0;
 }
 
 // Task 2: Move robot away from wall one pixel at a time
 void my_robot::move_away_from_wall_once() {
+    drop_path();
     // Determine direction to move away from wall
     int x_dir, y_dir;
     if (clockwise) {
@@ -491,8 +531,76 @@ void my_robot::move_away_from_wall_once() {
 
 // Task 2: Start sweep mode and prepare to return to top
 void my_robot::start_sweep_mode() {
-    sweep_mode = true;
-    returning_to_top = true;
+    nav.fire(EV_LAPPED_SWEEP);
+}
+
+// Task 2: plan the sweep from the walls mapped during the lap instead of sweeping reactively.
+// returns false if the lap left a gap in the walls and no plan could be made
+bool my_robot::start_coverage_mode(coverage_planner& planner) {
+    coverage_waypoints = planner.plan(inflated, this->x + radius, this->y + radius);
+    if (coverage_waypoints.empty()) {
+        return false;
+    }
+    nav.fire(EV_LAPPED_COVERAGE);
+    waypoint_index = 0;
+    segment.clear();
+    segment_index = 0;
+    std::cout << "Coverage planner: " << planner.get_num_cells() << " cells, "
+        << coverage_waypoints.size() << " waypoints" << std::endl;
+    return true;
+}
+
+// Task 2: take one step along the coverage path. Returns false once the last waypoint is reached
+bool my_robot::follow_coverage_path(coverage_planner& planner) {
+    drop_path();
+    std::pair<int, int> center{this->x + radius, this->y + radius};
+    // re-plan the current leg if a newly mapped wall blocks the next step
+    if (segment_index < segment.size() && 
+        !inflated.is_free(segment[segment_index].first, segment[segment_index].second)) {
+        segment = planner.connect(inflated, center, coverage_waypoints[waypoint_index-1]);
+        segment_index = 0;
+    }
+    // expand the next leg once the current one is done. unreachable waypoints are skipped
+    while (segment_index >= segment.size()) {
+        if (waypoint_index >= coverage_waypoints.size()) {
+            nav.fire(EV_FINISHED);
+            return false;
+        }
+        segment = planner.connect(inflated, center, coverage_waypoints[waypoint_index]);
+        segment_index = 0;
+        waypoint_index++;
+    }
+    this->x = segment[segment_index].first - radius;
+    this->y = segment[segment_index].second - radius;
+    segment_index++;
+    return true;
+}
+
+// explore by frontiers: head for the closest/largest boundary between free and unknown cells.
+// returns false once no reachable frontier is left
+bool my_robot::follow_frontiers(frontier_tracker& frontiers) {
+    drop_path();
+    int center_x = this->x + radius;
+    int center_y = this->y + radius;
+    if (revealed_box[2] >= 0) {
+        frontiers.update(grid, revealed_box[0], revealed_box[1], revealed_box[2], revealed_box[3]);
+    }
+    // re-plan when the target is reached or a new wall is in the way. the target usually gets mapped
+    // well before the robot arrives (it is at the edge of the LiDAR range), so that alone is not
+    // a reason to re-plan; it would mean a full re-plan every step
+    bool blocked = frontier_index < frontier_path.size() && inflated.is_free(center_x, center_y)
+        && !inflated.is_free(frontier_path[frontier_index].first, frontier_path[frontier_index].second);
+    if (frontier_index >= frontier_path.size() || blocked) {
+        frontier_path = frontiers.plan(inflated, center_x, center_y);
+        frontier_index = 0;
+        if (frontier_path.empty()) {
+            return false;
+        }
+    }
+    this->x = frontier_path[frontier_index].first - radius;
+    this->y = frontier_path[frontier_index].second - radius;
+    frontier_index++;
+    return true;
 }
 
 //===== Main parameters =====
@@ -501,6 +609,21 @@ const int radius {10};                              //Radius of the robot's circ
 const int min_obj_size {50};                        //Maximum object dimension. Not required for lab 3/4
 const int max_obj_size {100};                       //Maximum object dimension. Not required for lab 3/4
 int lidar_range{50};                                //Lidar range, radiating from center of robot
+int safety_margin{2};                               //Extra clearance added to the robot radius in the inflated layers
+bool use_frontier_exploration{false};               //Explore by frontiers instead of lap-then-sweep (same coverage, ~10% fewer steps, slower planning)
+bool use_coverage_planner{true};                    //Sweep with the coverage planner after the lap (false: reactive sweep)
+int lane_spacing{2*lidar_range - 10};               //Distance between coverage lanes, slightly under the LiDAR diameter
+std::string log_file{""};                           //Binary run log written during the run, empty for none (or --log <file>)
+int keyframe_interval{250};                         //Steps between keyframes of the robot's map in the run log, for replay
+bool split_view{true};                              //Play back ground truth and map side by side in one window
+bool live_render{false};                            //Show the run while it is simulated instead of playing it back after (or --live)
+std::string frame_prefix{""};                       //Write the playback as <prefix>_<step>.png instead of opening windows (or --frames <prefix>)
+int frame_stride{50};                               //Steps between exported frames (or --frame-stride <n>)
+int diff_region_size{100};                          //Side of the squares the map diff is summarised over
+int num_robots{1};                                  //Robots exploring together by frontiers, each with its own map (or --robots <n>)
+int num_threads{0};                                 //Threads stepping the team, 0 for one per core (or --threads <n>)
+int merge_interval{10};                             //Steps between team robots copying the team map into their own, 0 for never
+int yield_limit{20};                                //Steps a team robot waits for another one before planning around it
 
 // Grid utility class
 grid_util grid(env_width, env_height, min_obj_size, max_obj_size);
@@ -509,7 +632,174 @@ grid_util grid(env_width, env_height, min_obj_size, max_obj_size);
 random_generator rand_gen;
 
 // Vector of velocity commands
-std::vector<std::vector<int>> robot_pos;
+trajectory robot_pos;
+
+// run log record for the robot's current position
+log_record make_log_record(my_robot& robot, int step, uint8_t mode) {
+    log_record record{};
+    record.step = step;
+    record.x = robot.x;
+    record.y = robot.y;
+    record.mode = wall_probe::lookup(mode).axes;
+    record.flags = (robot.in_sweep_mode() ? LOG_SWEEP : 0) | (robot.is_clockwise() ? LOG_CLOCKWISE : 0)
+        | (robot.in_coverage_mode() ? LOG_COVERAGE : 0) | (robot.nav.state() == NAV_FRONTIER ? LOG_FRONTIER : 0)
+        | (grid.hits_wall(robot) ? LOG_COLLISION : 0);
+    return record;
+}
+
+// team mode: num_robots robots explore by frontiers at once, each with its own map. every step
+// they scan and move in parallel against the ground truth, which nobody writes meanwhile. then
+// their moves are checked against each other in robot order: a robot whose new footprint overlaps
+// another robot's waits, and plans around the others after waiting yield_limit steps. each step
+// the robots merge the tiles they mapped into the team map, and every merge_interval steps they
+// copy in what the others mapped
+int run_team(const std::tuple<std::string, bool, int, int>& config, std::vector<Object*>& walls, int env_type,
+    int min_y_spawn, int max_y_spawn)
+{
+    if (live_render || !log_file.empty()) {
+        std::cout << "Team mode: --live and --log are for a single robot, ignored" << std::endl;
+    }
+    step_pool pool(num_threads);
+    shared_map team_map(env_width, env_height);
+
+    // spawn the robots apart
+    std::vector<my_robot> team;
+    std::vector<frontier_tracker> trackers;
+    team.reserve(num_robots);
+    for (int i = 0; i < num_robots; i++) {
+        team.emplace_back(2*radius, 2*radius, env_width, min_y_spawn, max_y_spawn, radius+5, lidar_range, env_type, safety_margin);
+        bool apart = false;
+        for (int tries = 0; !apart && tries < 100; tries++) {
+            apart = true;
+            for (int j = 0; j < i; j++) {
+                if (footprints_overlap(team[i].x, team[i].y, team[j].x, team[j].y, radius)) {
+                    apart = false;
+                }
+            }
+            // redraw from the spawn band of the Object constructor
+            if (!apart) {
+                team[i].x = rand_gen.create_random(env_width/2 - 50, env_width/2 + 50);
+                team[i].y = rand_gen.create_random(min_y_spawn + 3*radius + 5, max_y_spawn - 3*radius - 5);
+            }
+        }
+        trackers.emplace_back(env_width, env_height, lidar_range);
+        team[i].nav.fire(EV_START_FRONTIER);
+    }
+    Object robot_init = team[0];
+    std::cout << "Team mode: " << num_robots << " robots on " << pool.get_num_threads() << " threads" << std::endl;
+
+    std::vector<trajectory> paths(num_robots);
+    std::vector<std::pair<int, int>> prev(num_robots);
+    std::vector<std::pair<int, int>> others;
+    std::vector<char> finished(num_robots, 0);      // not vector<bool>: written from several threads
+    std::vector<int> waiting(num_robots, 0), yields(num_robots, 0), done_step(num_robots, -1);
+    std::vector<long> pushed(num_robots, 0), pulled(num_robots, 0);
+    for (int i = 0; i < num_robots; i++) {
+        paths[i].push_back(team[i].x, team[i].y);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int limit_count = 0;
+    int num_finished = 0;
+    while (num_finished < num_robots && limit_count < 7200) {
+        limit_count++;
+        for (int i = 0; i < num_robots; i++) {
+            prev[i] = {team[i].x, team[i].y};
+        }
+        // scan, catch up with the team and move, each robot on its own map. nobody merges meanwhile,
+        // so every robot sees the team map as of the last step, whatever the threads do
+        bool catch_up = merge_interval > 0 && limit_count % merge_interval == 0;
+        pool.run(num_robots, [&](int i) {
+            if (finished[i]) {
+                return;
+            }
+            team[i].map_environment(grid);
+            if (catch_up) {
+                pulled[i] += team[i].pull_team_map(team_map, trackers[i]);
+            }
+            if (!team[i].follow_frontiers(trackers[i])) {
+                finished[i] = 1;
+            }
+            team[i].nav.tick();
+        });
+        // merge what each robot mapped this step, only the tiles it touched
+        pool.run(num_robots, [&](int i) {
+            pushed[i] += team[i].tiles.push(team_map, team[i].grid);
+        });
+        // check the moves in robot order: robots before i are where they end the step, the ones
+        // after it where they started it. positions at the start never overlap, so neither do the ends
+        for (int i = 0; i < num_robots; i++) {
+            if (finished[i] && done_step[i] < 0) {
+                done_step[i] = limit_count;
+                num_finished++;
+            }
+            others.clear();
+            for (int j = 0; j < num_robots; j++) {
+                if (j != i) {
+                    others.push_back((j < i) ? std::make_pair(team[j].x, team[j].y) : prev[j]);
+                }
+            }
+            bool blocked = false;
+            for (const std::pair<int, int>& other: others) {
+                blocked = blocked || footprints_overlap(team[i].x, team[i].y, other.first, other.second, radius);
+            }
+            if (blocked) {
+                team[i].yield_step(prev[i].first, prev[i].second);
+                yields[i]++;
+                // waiting doesn't clear a head on standoff, or a robot parked on the path
+                if (++waiting[i] > yield_limit) {
+                    team[i].replan_around(others, trackers[i]);
+                    waiting[i] = 0;
+                }
+            }
+            else {
+                waiting[i] = 0;
+            }
+            if (!finished[i]) {
+                paths[i].push_back(team[i].x, team[i].y);
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "====Team stopped after " << limit_count << " iterations, " << num_finished << " of " << num_robots
+        << " robots out of frontiers, " << seconds << " s====" << std::endl;
+
+    // the team map, and how much each robot contributed on its own
+    std::vector<std::vector<int>> team_grid = team_map.to_grid();
+    std::cout << std::fixed << std::setprecision(2);
+    for (int i = 0; i < num_robots; i++) {
+        std::cout << "Robot " << i << ": " << paths[i].size() << " positions, " << yields[i] << " yields, "
+            << pushed[i] << " tiles merged, " << pulled[i] << " pulled, "
+            << grid.grid_accuracy(team[i].grid)*100.0 << "% of the environment";
+        if (done_step[i] >= 0) {
+            std::cout << ", out of frontiers at step " << done_step[i];
+        }
+        std::cout << std::endl;
+    }
+    // against copying every robot's whole map into the team map each step
+    double merged_mb = team_map.get_num_merges()*tile_size*tile_size/1e6;
+    double full_mb = (double)limit_count*num_robots*env_width*env_height/1e6;
+    std::cout << "Team map: " << team_map.get_num_merges() << " tile merges, " << merged_mb << " MB merged against "
+        << full_mb << " MB for whole map merges" << std::endl;
+    std::cout << "Percent of walls correctly mapped: " << grid.wall_accuracy(team_grid)*100.0 << "%" << std::endl;
+    std::cout << "Percent of environment correctly mapped: " << grid.grid_accuracy(team_grid)*100.0 << "%" << std::endl;
+    std::vector<uint8_t> diff = grid.diff_map(team_grid);
+    grid.print_diff_summary(diff, diff_region_size);
+
+    // playback shows the first robot over the team map
+    if (!frame_prefix.empty()) {
+        int frames = export_frames(paths[0], walls, team_grid, env_width, env_height, radius, lidar_range,
+            frame_stride, frame_prefix);
+        std::cout << frames << " frames written to " << frame_prefix << "_*.png" << std::endl;
+    }
+    else if (std::get<1>(config) && split_view) {
+        render_split(paths[0], walls, team_grid, env_width, env_height, radius, lidar_range, std::get<2>(config), diff);
+    }
+    else {
+        render_grid(robot_init, paths[0], team_grid, env_width, env_height, radius, lidar_range, std::get<2>(config), diff);
+    }
+    return 0;
+}
 
 int main(int argc, char const *argv[])
 {
@@ -536,6 +826,9 @@ int main(int argc, char const *argv[])
     else {
         walls = grid.create_angled_walls(std::get<0>(config));
     }
+    // dilate walls by the robot footprint so planners can check the robot center only
+    grid.build_inflation(radius, safety_margin);
+
     // get minimum/maximum y values for the robot to spawn
     int min_y_spawn = grid.get_min_y();
     int max_y_spawn = grid.get_max_y();
@@ -544,11 +837,91 @@ int main(int argc, char const *argv[])
     // grid.writeGridToCSV("grid.csv"); 
 
     // Create robot with environment type
-    my_robot robot(2*radius, 2*radius, env_width, min_y_spawn, max_y_spawn, radius+5, lidar_range, env_type);
+    my_robot robot(2*radius, 2*radius, env_width, min_y_spawn, max_y_spawn, radius+5, lidar_range, env_type, safety_margin);
     my_robot robot_init = robot;
 
+    // coverage planner for the sweep after the lap
+    coverage_planner planner(env_width, env_height, lane_spacing);
+    // frontier tracker for frontier exploration
+    frontier_tracker frontiers(env_width, env_height, lidar_range);
+
+    // command line options. counts must be whole numbers, at least 1 (0 is allowed for --threads,
+    // one per core, and --merge-interval, never)
+    bool valid = true;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--live") {
+            live_render = true;
+        }
+        else if (i+1 >= argc) {
+            break;
+        }
+        else if (std::string(argv[i]) == "--log") {
+            log_file = argv[i+1];
+        }
+        else if (std::string(argv[i]) == "--frames") {
+            frame_prefix = argv[i+1];
+        }
+        else if (std::string(argv[i]) == "--frame-stride") {
+            valid = parse_int(argv[i+1], 1, frame_stride);
+        }
+        else if (std::string(argv[i]) == "--robots") {
+            valid = parse_int(argv[i+1], 1, num_robots);
+        }
+        else if (std::string(argv[i]) == "--threads") {
+            valid = parse_int(argv[i+1], 0, num_threads);
+        }
+        else if (std::string(argv[i]) == "--merge-interval") {
+            valid = parse_int(argv[i+1], 0, merge_interval);
+        }
+        if (!valid) {
+            std::cerr << "usage: " << argv[0] << " [--live] [--log <file>] [--frames <prefix>] [--frame-stride <n>]"
+                << " [--robots <n>] [--threads <n>] [--merge-interval <n>]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (num_robots > 1) {
+        return run_team(config, walls, env_type, min_y_spawn, max_y_spawn);
+    }
+
+    // show the run while it is simulated. the window gets its own thread and only sees what the
+    // simulation publishes, so the simulation runs exactly as it does without it
+    live_channel live(live_render ? 1 << 20 : 1);
+    std::thread live_thread;
+    if (live_render) {
+        robot.live = &live;
+        live_thread = std::thread(render_live, std::ref(live), std::ref(walls), std::cref(robot.grid),
+            env_width, env_height, radius);
+    }
+
+    // stream the run to disk if asked to
+    run_logger logger;
+    if (!log_file.empty()) {
+        log_header header{};
+        header.env_width = env_width;
+        header.env_height = env_height;
+        header.radius = radius;
+        header.lidar_range = lidar_range;
+        header.env_type = env_type;
+        header.keyframe_interval = keyframe_interval;
+        logger.open(log_file, header);
+    }
+
+    // frontier exploration replaces the lap and sweep. the setup time isn't the controller's
+    robot.nav.restart_clock();
+    if (use_frontier_exploration) {
+        robot.nav.fire(EV_START_FRONTIER);
+    }
+
     // push the initial position onto robot_pos
-    robot_pos.push_back({robot.x, robot.y});
+    robot_pos.push_back(robot.x, robot.y);
+    if (live_render) {
+        live.publish_position(robot.x, robot.y);
+    }
+    uint8_t mode = 0;
+    if (logger.is_open()) {
+        logger.log(make_log_record(robot, 0, mode));
+    }
     int limit_count = 0;
     // run the program indefinitely until robot hits the goal or an obstacle
 
@@ -557,15 +930,31 @@ int main(int argc, char const *argv[])
     while (true)
     {
         limit_count++;
+        // the controller's time is charged to its states; recording the step below is not
+        robot.nav.restart_clock();
         
         // Task 2 Psuedo code
         // 1. initialize the robot to travel in the clockwise direction (already done in class)
         // 2. detect_walls()
         robot.map_environment(grid);
-        std::array<int, 4> mode = robot.detect_walls();
+        mode = robot.detect_walls();
         
+        // frontier exploration: no lap or sweep, go wherever is still unknown
+        if (robot.nav.state() == NAV_FRONTIER) {
+            if (!robot.follow_frontiers(frontiers)) {
+                std::cout << "====No frontiers left after " << limit_count << " iterations====" << std::endl;
+                break;
+            }
+        }
+        // planned sweep: follow the coverage path until its last waypoint
+        else if (robot.in_coverage_mode()) {
+            if (!robot.follow_coverage_path(planner)) {
+                std::cout << "====Coverage path finished after " << limit_count << " iterations====" << std::endl;
+                break;
+            }
+        }
         //3. if the robot not in sweep mode
-        if (!robot.in_sweep_mode()) {
+        else if (!robot.in_sweep_mode()) {
             //4. find_dir()
             std::pair<int, int> wall_vec = robot.find_dir(mode);
             
@@ -579,7 +968,15 @@ int main(int argc, char const *argv[])
             if (robot.check_if_lapped()) {
                 // 8. y_ref = robot.y (handled in start_sweep_mode)
                 // 9. go to sweep mode
-                robot.start_sweep_mode();
+                if (use_coverage_planner) {
+                    // walls not closed yet: keep following them for another lap
+                    if (!robot.start_coverage_mode(planner)) {
+                        robot.restart_lap();
+                    }
+                }
+                else {
+                    robot.start_sweep_mode();
+                }
             }
         }
         // 10. if the robot in sweep mode
@@ -590,7 +987,7 @@ int main(int argc, char const *argv[])
                 // Continue moving until we reach min_y (top)
                 if (current_center_y <= robot.get_min_y()) {
                     // Reached the top, now start actual sweep
-                    robot.set_returning_to_top(false);
+                    robot.reached_top();
                     robot.update_y_ref(); // Set y_ref to current position at top
                 } else {
                     // Keep following walls to get to top
@@ -636,17 +1033,11 @@ int main(int argc, char const *argv[])
 
                 // Detect walls after moving to check for wall hits
                 robot.map_environment(grid);
-                std::array<int, 4> mode_after = robot.detect_walls();
+                uint8_t mode_after = robot.detect_walls();
                 
                 // 12. if robot's {x, y, v, w} was previously {0, 0, 0, 0} and it hits wall
-                std::array<int, 4> prev_mode_stored = robot.get_mode_before_move();
-                bool was_free = true;
-                bool now_hits_wall = false;
-                
-                for (int i = 0; i < 4; i++) {
-                    if (prev_mode_stored[i] != 0) was_free = false;
-                    if (mode_after[i] != 0) now_hits_wall = true;
-                }
+                bool was_free = robot.get_mode_before_move() == 0;
+                bool now_hits_wall = mode_after != 0;
                 
                 if (was_free && now_hits_wall) {
                     // 13. toggle direction (between clockwise and counterclockwise)
@@ -668,7 +1059,13 @@ int main(int argc, char const *argv[])
                         while ((robot.y + radius) < robot.get_max_y()) {
                             robot.y++;
                             robot.map_environment(grid);
-                            robot_pos.push_back({robot.x, robot.y});
+                            robot_pos.push_back(robot.x, robot.y);
+                            if (live_render) {
+                                live.publish_position(robot.x, robot.y);
+                            }
+                            if (logger.is_open()) {
+                                logger.log(make_log_record(robot, limit_count, mode));
+                            }
                         }
                         break;
                     }
@@ -677,7 +1074,17 @@ int main(int argc, char const *argv[])
         }
         
 
-        robot_pos.push_back({robot.x, robot.y});
+        robot.nav.tick();
+        robot_pos.push_back(robot.x, robot.y);
+        if (live_render) {
+            live.publish_position(robot.x, robot.y);
+        }
+        if (logger.is_open()) {
+            logger.log(make_log_record(robot, limit_count, mode));
+            if (keyframe_interval > 0 && limit_count % keyframe_interval == 0) {
+                logger.log_keyframe(limit_count, robot.grid);
+            }
+        }
 
         if (limit_count>=7200) {
             std::cout << "====Program terminated after 7200 iterations====" << std::endl;
@@ -685,18 +1092,52 @@ int main(int argc, char const *argv[])
         }
     }
 
+    robot.nav.fire(EV_FINISHED);
+    robot.nav.print_profile(std::cout);
+
+    // the map is final from here on; the live view may read it
+    live.finish();
+
+    if (logger.is_open()) {
+        // the final map, so a replay of the last step is exact
+        if (keyframe_interval > 0 && limit_count % keyframe_interval != 0) {
+            logger.log_keyframe(limit_count, robot.grid);
+        }
+        logger.close();
+        std::cout << "Run log: " << logger.get_num_records() << " records written to " << log_file << std::endl;
+    }
+
     // Accuracy calculations
     std::cout << std::fixed << std::setprecision(2);
     float wall_accuracy = grid.wall_accuracy(robot.grid);
     float accuracy = grid.grid_accuracy(robot.grid);
     std::cout << "Percent of walls correctly mapped: " << wall_accuracy*100.0 << "%" << std::endl;
     std::cout << "Percent of environment correctly mapped: " << accuracy*100.0 << "%" << std::endl;
+
+    // where the map is wrong, cell by cell
+    std::vector<uint8_t> diff = grid.diff_map(robot.grid);
+    grid.print_diff_summary(diff, diff_region_size);
     
-    if (std::get<1>(config)){
-        render_window(robot_pos, walls, robot_init, env_width, env_height, std::get<2>(config));
+    // the live window already showed the run: wait for it to be closed
+    if (live_render) {
+        live_thread.join();
+    }
+    // headless: frames to disk, no windows
+    else if (!frame_prefix.empty()) {
+        int frames = export_frames(robot_pos, walls, robot.grid, env_width, env_height, radius, lidar_range,
+            frame_stride, frame_prefix);
+        std::cout << frames << " frames written to " << frame_prefix << "_*.png" << std::endl;
+    }
+    else if (std::get<1>(config) && split_view){
+        render_split(robot_pos, walls, robot.grid, env_width, env_height, radius, lidar_range, std::get<2>(config), diff);
+    }
+    else {
+        if (std::get<1>(config)){
+            render_window(robot_pos, walls, robot_init, env_width, env_height, std::get<2>(config));
+        }
+
+        render_grid(robot_init, robot_pos, robot.grid, env_width, env_height, radius, lidar_range, std::get<2>(config), diff);
     }
-    
-    render_grid(robot_init, robot_pos, robot.grid, env_width, env_height, radius, lidar_range, std::get<2>(config));
 
     return 0;
 }
@@ -0,0 +1,99 @@
+// live view of a run: the simulation publishes the robot's position and every map cell it changes
+// into a lock-free single producer/single consumer ring, and the render thread drains it each frame.
+// publishing never waits: if the renderer falls a whole ring behind, updates are dropped and counted
+#ifndef LIVE
+#define LIVE
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// bounded lock-free ring for exactly one producer thread and one consumer thread
+template <typename T>
+class spsc_queue {
+    std::vector<T> slots;
+    size_t mask;
+    // each index is written by one side only; separate cache lines so they don't false share
+    alignas(64) std::atomic<size_t> head{0};    // next slot to read, written by the consumer
+    alignas(64) std::atomic<size_t> tail{0};    // next slot to write, written by the producer
+    public:
+        // capacity is rounded up to a power of two
+        spsc_queue(size_t capacity) {
+            size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            slots.resize(size);
+            mask = size - 1;
+        }
+        // producer: false if the ring is full
+        bool push(const T& item) {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == slots.size()) {
+                return false;
+            }
+            slots[t & mask] = item;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+        // consumer: false if the ring is empty
+        bool pop(T& item) {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = slots[h & mask];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+};
+
+enum live_kind : uint8_t {
+    LIVE_POSITION,                      // robot moved to (x, y), top left corner
+    LIVE_CELL                           // map cell (x, y) changed to value
+};
+
+struct live_update {
+    int16_t x, y;
+    int8_t value;
+    uint8_t kind;                       // live_kind
+};
+
+class live_channel {
+    spsc_queue<live_update> queue;
+    size_t dropped{0};                  // written by the simulation, read once finished
+    std::atomic<bool> finished{false};
+    public:
+        // constructor. a run changes each cell only a few times, so the default ring (6 MB) holds
+        // more than a whole run's worth of updates
+        live_channel(size_t capacity = 1 << 20) : queue(capacity) {}
+        // simulation side
+        void publish_position(int x, int y) {
+            if (!queue.push(live_update{(int16_t)x, (int16_t)y, 0, LIVE_POSITION})) {
+                dropped++;
+            }
+        }
+        void publish_cell(int x, int y, int value) {
+            if (!queue.push(live_update{(int16_t)x, (int16_t)y, (int8_t)value, LIVE_CELL})) {
+                dropped++;
+            }
+        }
+        // the simulation is done and no longer writes its map
+        void finish() {
+            finished.store(true, std::memory_order_release);
+        }
+        // render side
+        bool poll(live_update& update) {
+            return queue.pop(update);
+        }
+        bool is_finished() {
+            return finished.load(std::memory_order_acquire);
+        }
+        // only valid once is_finished()
+        size_t get_dropped() {
+            return this->dropped;
+        }
+};
+
+#endif
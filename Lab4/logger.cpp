@@ -0,0 +1,240 @@
+// streaming binary log of a run
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "logger.h"
+
+// constructor
+run_logger::run_logger() {
+}
+
+run_logger::~run_logger() {
+    close();
+}
+
+// create the file, write the header and start the writer thread. false if the file can't be opened
+bool run_logger::open(const std::string& filename, const log_header& header) {
+    close();
+    file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Run log: could not open " << filename << std::endl;
+        return false;
+    }
+    log_header h = header;
+    std::memcpy(h.magic, "RLOG", 4);
+    h.version = 2;
+    std::fwrite(&h, sizeof(h), 1, file);
+    if (h.keyframe_interval > 0) {
+        keys = std::fopen((filename + ".keys").c_str(), "wb");
+        if (keys == nullptr) {
+            std::cerr << "Run log: could not open " << filename << ".keys, no keyframes" << std::endl;
+        }
+        key_size = sizeof(uint32_t) + (h.env_width*h.env_height + 3) / 4;
+    }
+    active.reserve(buffer_size);
+    stopping = false;
+    num_records = 0;
+    writer = std::thread(&run_logger::write_loop, this);
+    return true;
+}
+
+// append one record. only blocks if the writer is max_pending buffers behind, so memory stays bounded
+void run_logger::log(const log_record& record) {
+    if (file == nullptr) {
+        return;
+    }
+    active.push_back(record);
+    num_records++;
+    if (active.size() == buffer_size) {
+        hand_off();
+    }
+}
+
+// pack the robot's map as it is at the end of step and hand it to the writer. only blocks if the
+// writer is max_pending_keys keyframes behind
+void run_logger::log_keyframe(uint32_t step, const std::vector<std::vector<int>>& grid) {
+    if (keys == nullptr) {
+        return;
+    }
+    std::vector<uint8_t> key;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!spare_keys.empty()) {
+            key = std::move(spare_keys.back());
+            spare_keys.pop_back();
+        }
+    }
+    key.assign(key_size, 0);
+    std::memcpy(key.data(), &step, sizeof(step));
+    uint8_t *packed = key.data() + sizeof(step);
+    size_t c = 0;
+    for (size_t i = 0; i < grid.size(); i++) {
+        for (size_t j = 0; j < grid[i].size(); j++, c++) {
+            uint8_t value = grid[i][j] < 0 ? 0 : (grid[i][j] == 0 ? 1 : 2);
+            packed[c / 4] |= value << (2*(c % 4));
+        }
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    drained.wait(guard, [this] { return pending_keys.size() < max_pending_keys; });
+    pending_keys.push_back(std::move(key));
+    ready.notify_one();
+}
+
+// pass the active buffer to the writer and continue in a spare one
+void run_logger::hand_off() {
+    std::unique_lock<std::mutex> guard(lock);
+    drained.wait(guard, [this] { return pending.size() < max_pending; });
+    pending.push_back(std::move(active));
+    if (!spare.empty()) {
+        active = std::move(spare.back());
+        spare.pop_back();
+    }
+    else {
+        active = std::vector<log_record>();
+        active.reserve(buffer_size);
+    }
+    ready.notify_one();
+}
+
+void run_logger::write_loop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        ready.wait(guard, [this] { return stopping || !pending.empty() || !pending_keys.empty(); });
+        if (pending.empty() && pending_keys.empty()) {
+            break;
+        }
+        // write without holding the lock so the main loop can keep handing off buffers
+        if (!pending.empty()) {
+            std::vector<log_record> buffer = std::move(pending.front());
+            pending.pop_front();
+            drained.notify_one();
+            guard.unlock();
+            std::fwrite(buffer.data(), sizeof(log_record), buffer.size(), file);
+            buffer.clear();
+            guard.lock();
+            spare.push_back(std::move(buffer));
+        }
+        else {
+            std::vector<uint8_t> key = std::move(pending_keys.front());
+            pending_keys.pop_front();
+            drained.notify_one();
+            guard.unlock();
+            std::fwrite(key.data(), 1, key.size(), keys);
+            guard.lock();
+            spare_keys.push_back(std::move(key));
+        }
+    }
+}
+
+// flush what is left, stop the writer and close the file
+void run_logger::close() {
+    if (file == nullptr) {
+        return;
+    }
+    if (!active.empty()) {
+        hand_off();
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_one();
+    writer.join();
+    std::fclose(file);
+    file = nullptr;
+    if (keys != nullptr) {
+        std::fclose(keys);
+        keys = nullptr;
+    }
+}
+
+bool run_logger::is_open() {
+    return file != nullptr;
+}
+
+size_t run_logger::get_num_records() {
+    return this->num_records;
+}
+
+// load the header and all records of a run log. false if it is missing or not a run log
+bool read_run_log(const std::string& filename, log_header& header, std::vector<log_record>& records) {
+    FILE *in = std::fopen(filename.c_str(), "rb");
+    if (in == nullptr) {
+        std::cerr << "Run log: could not open " << filename << std::endl;
+        return false;
+    }
+    if (std::fread(&header, sizeof(header), 1, in) != 1 || std::memcmp(header.magic, "RLOG", 4) != 0
+        || header.version != 2) {
+        std::cerr << "Run log: " << filename << " is not a version 2 run log" << std::endl;
+        std::fclose(in);
+        return false;
+    }
+    records.clear();
+    log_record buffer[4096];
+    size_t n;
+    while ((n = std::fread(buffer, sizeof(log_record), 4096, in)) > 0) {
+        records.insert(records.end(), buffer, buffer + n);
+    }
+    std::fclose(in);
+    return true;
+}
+
+// unpack the last keyframe at or before step into grid (resized to the environment). returns the
+// keyframe's step, or -1 if there is none (grid is then all unknown)
+int read_keyframe(const std::string& filename, const log_header& header, uint32_t step,
+    std::vector<std::vector<int>>& grid)
+{
+    grid = std::vector<std::vector<int>>(header.env_width, std::vector<int>(header.env_height, -1));
+    FILE *in = std::fopen((filename + ".keys").c_str(), "rb");
+    if (in == nullptr) {
+        return -1;
+    }
+    // keyframes are in step order and all the same size: binary search for the last one at or
+    // before step, reading only the steps of the keyframes it probes
+    size_t packed_size = (header.env_width*header.env_height + 3) / 4;
+    long key_size = sizeof(uint32_t) + packed_size;
+    std::fseek(in, 0, SEEK_END);
+    long lo = 0, hi = std::ftell(in) / key_size;      // keyframes [0, lo) are at or before step, [hi, ...) after
+    uint32_t key_step;
+    while (lo < hi) {
+        long mid = lo + (hi - lo)/2;
+        std::fseek(in, mid*key_size, SEEK_SET);
+        if (std::fread(&key_step, sizeof(key_step), 1, in) == 1 && key_step <= step) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    long best = lo - 1;
+    int best_step = -1;
+    if (best >= 0) {
+        std::fseek(in, best*key_size, SEEK_SET);
+        if (std::fread(&key_step, sizeof(key_step), 1, in) == 1) {
+            best_step = key_step;
+        }
+        else {
+            best = -1;
+        }
+    }
+    if (best >= 0) {
+        std::vector<uint8_t> packed(packed_size);
+        std::fseek(in, best*key_size + sizeof(key_step), SEEK_SET);
+        if (std::fread(packed.data(), 1, packed_size, in) != packed_size) {
+            best_step = -1;
+        }
+        else {
+            size_t c = 0;
+            for (int i = 0; i < header.env_width; i++) {
+                for (int j = 0; j < header.env_height; j++, c++) {
+                    grid[i][j] = ((packed[c / 4] >> (2*(c % 4))) & 3) - 1;
+                }
+            }
+        }
+    }
+    std::fclose(in);
+    return best_step;
+}
@@ -0,0 +1,85 @@
+// streaming binary log of a run: one fixed size record per recorded position, written to disk by a
+// background thread so the main loop only copies 12 bytes per step. keyframes of the robot's map
+// go to <log file>.keys through the same thread, so a replay can jump to any step without
+// re-simulating
+#ifndef LOGGER
+#define LOGGER
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// file layout: log_header, then log_record until the end of the file
+struct log_header {
+    char magic[4];                      // "RLOG"
+    uint16_t version;
+    uint16_t env_width, env_height;
+    uint16_t radius, lidar_range;
+    uint16_t env_type;
+    uint16_t keyframe_interval;         // steps between map keyframes, 0 for none
+};
+
+// keyframe file layout: uint32 step, then the map packed 2 bits per cell (0 unknown, 1 free,
+// 2 wall) in x*env_height + y order. every keyframe has the same size, so they can be seeked to
+
+// flags of a log_record
+enum log_flags : uint8_t {
+    LOG_SWEEP = 1,                      // reactive sweep after the lap
+    LOG_CLOCKWISE = 2,                  // wall following direction
+    LOG_COVERAGE = 4,                   // following the coverage planner
+    LOG_FRONTIER = 8,                   // frontier exploration
+    LOG_COLLISION = 16                  // robot footprint overlaps a true wall
+};
+
+struct log_record {
+    uint32_t step;                      // main loop iteration
+    int16_t x, y;                       // robot position (top left corner)
+    uint8_t mode;                       // axes with a wall in detect_walls(), bit i for x, y, v, w
+    uint8_t flags;                      // log_flags
+    uint16_t reserved;
+};
+
+class run_logger {
+    static const size_t buffer_size = 4096;     // records per buffer (48 KB)
+    static const size_t max_pending = 8;        // full buffers waiting for the writer before log() blocks
+    static const size_t max_pending_keys = 2;   // keyframes waiting for the writer before log_keyframe() blocks
+    FILE *file{nullptr};
+    FILE *keys{nullptr};
+    size_t key_size{0};                         // bytes per keyframe: its step and the packed map
+    std::vector<log_record> active;             // filled by the main loop
+    std::deque<std::vector<log_record>> pending;    // full buffers handed to the writer
+    std::vector<std::vector<log_record>> spare;     // written buffers, reused to avoid allocating
+    std::deque<std::vector<uint8_t>> pending_keys;  // packed keyframes handed to the writer
+    std::vector<std::vector<uint8_t>> spare_keys;   // written keyframes, reused like spare
+    std::mutex lock;
+    std::condition_variable ready, drained;
+    std::thread writer;
+    bool stopping{false};
+    size_t num_records{0};
+    private:
+        void write_loop();
+        void hand_off();
+    public:
+        // constructor
+        run_logger();
+        ~run_logger();
+        // functions
+        bool open(const std::string&, const log_header&);
+        void log(const log_record&);
+        void log_keyframe(uint32_t, const std::vector<std::vector<int>>&);
+        void close();
+        // getters
+        bool is_open();
+        size_t get_num_records();
+};
+
+// reading a run log back, for the replay tool
+bool read_run_log(const std::string&, log_header&, std::vector<log_record>&);
+int read_keyframe(const std::string&, const log_header&, uint32_t, std::vector<std::vector<int>>&);
+
+#endif
@@ -0,0 +1,152 @@
+// team map merging by tiles
+
+#include <algorithm>
+
+#include "map_merge.h"
+
+// constructor
+shared_map::shared_map(int env_width, int env_height):
+    env_width(env_width),
+    env_height(env_height),
+    tiles_x((env_width + tile_size - 1) / tile_size),
+    tiles_y((env_height + tile_size - 1) / tile_size)
+{
+    std::shared_ptr<map_tile> unknown = std::make_shared<map_tile>();
+    std::fill(unknown->cells, unknown->cells + tile_size*tile_size, -1);
+    tiles.assign(tiles_x*tiles_y, unknown);
+    writers.reset(new std::mutex[tiles_x*tiles_y]);
+    versions.reset(new std::atomic<uint32_t>[tiles_x*tiles_y]);
+    for (int t = 0; t < tiles_x*tiles_y; t++) {
+        versions[t].store(0);
+    }
+}
+
+std::array<int, 4> shared_map::tile_box(int t) const {
+    int x0 = (t / tiles_y)*tile_size, y0 = (t % tiles_y)*tile_size;
+    return {x0, y0, std::min(x0 + tile_size, env_width), std::min(y0 + tile_size, env_height)};
+}
+
+// merge a robot's cells of tile t: cells the team map doesn't know yet are copied in. the tile is
+// replaced by an updated copy, so readers holding the old one are unaffected. false if the robot
+// had nothing new
+bool shared_map::merge(int t, const std::vector<std::vector<int>>& grid) {
+    std::array<int, 4> box = tile_box(t);
+    std::lock_guard<std::mutex> guard(writers[t]);
+    std::shared_ptr<const map_tile> current = std::atomic_load(&tiles[t]);
+    std::shared_ptr<map_tile> next;
+    for (int x = box[0]; x < box[2]; x++) {
+        const std::vector<int>& col = grid[x];
+        const int8_t *cells = &current->cells[(x - box[0])*tile_size];
+        for (int y = box[1]; y < box[3]; y++) {
+            if (cells[y - box[1]] != -1 || col[y] == -1) {
+                continue;
+            }
+            if (!next) {
+                next = std::make_shared<map_tile>(*current);
+            }
+            next->cells[(x - box[0])*tile_size + (y - box[1])] = col[y];
+        }
+    }
+    if (!next) {
+        return false;
+    }
+    next->version++;
+    std::atomic_store(&tiles[t], std::shared_ptr<const map_tile>(next));
+    versions[t].store(next->version, std::memory_order_release);
+    num_merges++;
+    return true;
+}
+
+std::shared_ptr<const map_tile> shared_map::load(int t) const {
+    return std::atomic_load(&tiles[t]);
+}
+
+// the whole team map as a grid
+std::vector<std::vector<int>> shared_map::to_grid() const {
+    std::vector<std::vector<int>> grid(env_width, std::vector<int>(env_height, -1));
+    for (int t = 0; t < tiles_x*tiles_y; t++) {
+        std::shared_ptr<const map_tile> tile = load(t);
+        std::array<int, 4> box = tile_box(t);
+        for (int x = box[0]; x < box[2]; x++) {
+            for (int y = box[1]; y < box[3]; y++) {
+                grid[x][y] = tile->cells[(x - box[0])*tile_size + (y - box[1])];
+            }
+        }
+    }
+    return grid;
+}
+
+int shared_map::get_num_tiles() const {
+    return this->tiles_x*this->tiles_y;
+}
+
+int shared_map::get_tiles_y() const {
+    return this->tiles_y;
+}
+
+uint32_t shared_map::get_version(int t) const {
+    return this->versions[t].load(std::memory_order_acquire);
+}
+
+long shared_map::get_num_merges() const {
+    return this->num_merges.load();
+}
+
+// tile tracker
+// default constructor
+tile_tracker::tile_tracker() {}
+
+tile_tracker::tile_tracker(int env_width, int env_height):
+    tiles_y((env_height + tile_size - 1) / tile_size)
+{
+    int num_tiles = ((env_width + tile_size - 1) / tile_size)*tiles_y;
+    local.assign(num_tiles, 0);
+    pushed.assign(num_tiles, 0);
+    pulled.assign(num_tiles, 0);
+}
+
+// merge the tiles mapped since the last push into the team map, returns the tiles that added cells
+int tile_tracker::push(shared_map& team, const std::vector<std::vector<int>>& grid) {
+    int merged = 0;
+    for (int t: dirty) {
+        merged += team.merge(t, grid);
+        pushed[t] = local[t];
+    }
+    dirty.clear();
+    return merged;
+}
+
+// copy the team map's newer tiles into grid, filling only its unknown cells. returns the tiles
+// that filled any; wall_box grows to cover the cells that became walls
+std::vector<int> tile_tracker::pull(const shared_map& team, std::vector<std::vector<int>>& grid,
+    std::array<int, 4>& wall_box) {
+    std::vector<int> filled;
+    for (int t = 0; t < team.get_num_tiles(); t++) {
+        if (team.get_version(t) <= pulled[t]) {
+            continue;
+        }
+        std::shared_ptr<const map_tile> tile = team.load(t);
+        std::array<int, 4> box = team.tile_box(t);
+        bool any = false;
+        for (int x = box[0]; x < box[2]; x++) {
+            std::vector<int>& col = grid[x];
+            const int8_t *cells = &tile->cells[(x - box[0])*tile_size];
+            for (int y = box[1]; y < box[3]; y++) {
+                if (col[y] != -1 || cells[y - box[1]] == -1) {
+                    continue;
+                }
+                col[y] = cells[y - box[1]];
+                any = true;
+                if (col[y] >= 1) {
+                    wall_box = {std::min(wall_box[0], x), std::min(wall_box[1], y),
+                        std::max(wall_box[2], x), std::max(wall_box[3], y)};
+                }
+            }
+        }
+        pulled[t] = tile->version;
+        if (any) {
+            filled.push_back(t);
+        }
+    }
+    return filled;
+}
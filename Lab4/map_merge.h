@@ -0,0 +1,67 @@
+// team map merging by tiles. the environment is split into 32x32 tiles; each robot counts what it
+// maps per tile and merges only the tiles that changed since its last merge into the shared map,
+// so a merge costs what is new rather than the whole map. the shared map is read-copy-update:
+// readers load a tile without locking, writers merge into a copy and publish it with a new version
+#ifndef MAP_MERGE
+#define MAP_MERGE
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+const int tile_size = 32;
+
+struct map_tile {
+    uint32_t version{0};                // merges that added cells to the tile
+    int8_t cells[tile_size*tile_size];  // -1 unknown, 0 free, 1 wall. x major, like the grids
+};
+
+class shared_map {
+    int env_width, env_height;
+    int tiles_x, tiles_y;
+    std::vector<std::shared_ptr<const map_tile>> tiles;    // std::atomic_load/store only
+    std::unique_ptr<std::mutex[]> writers;                  // one merge per tile at a time
+    std::unique_ptr<std::atomic<uint32_t>[]> versions;      // published versions, to skip tiles cheaply
+    std::atomic<long> num_merges{0};
+    public:
+        // constructor, all unknown
+        shared_map(int, int);
+        // functions
+        bool merge(int, const std::vector<std::vector<int>>&);
+        std::shared_ptr<const map_tile> load(int) const;
+        std::vector<std::vector<int>> to_grid() const;
+        // tile t covers [x0, x1) x [y0, y1)
+        std::array<int, 4> tile_box(int) const;
+        // getters
+        int get_num_tiles() const;
+        int get_tiles_y() const;
+        uint32_t get_version(int) const;
+        long get_num_merges() const;
+};
+
+// one robot's side: what it mapped since its last merge, and the team map versions it has seen
+class tile_tracker {
+    int tiles_y{0};
+    std::vector<uint32_t> local;        // bumped for every cell the robot maps
+    std::vector<uint32_t> pushed;       // local version at the last merge
+    std::vector<uint32_t> pulled;       // team map version last copied into the robot's map
+    std::vector<int> dirty;             // tiles with local > pushed
+    public:
+        // constructor
+        tile_tracker();
+        tile_tracker(int, int);
+        // functions
+        void touch(int x, int y) {
+            int t = (x / tile_size)*tiles_y + y / tile_size;
+            if (local[t]++ == pushed[t]) {
+                dirty.push_back(t);
+            }
+        }
+        int push(shared_map&, const std::vector<std::vector<int>>&);
+        std::vector<int> pull(const shared_map&, std::vector<std::vector<int>>&, std::array<int, 4>&);
+};
+
+#endif
@@ -0,0 +1,32 @@
+// straight line motion primitive: the pixel path between two points, generated with Bresenham
+// integer stepping (no floating point, no allocation). each time step moves up to max_speed
+// pixels along the line, a pixel being one step in x, in y or diagonally in both
+#ifndef MOTION
+#define MOTION
+
+#include "trajectory.h"
+
+class line_motion {
+    int x{0}, y{0};                     // current point on the line
+    int x1{0}, y1{0};                   // end of the line
+    int dx{0}, dy{0};                   // |x1 - x0| and -|y1 - y0|
+    int sx{1}, sy{1};                   // direction of each axis
+    int err{0};                         // Bresenham error term, dx + dy at the start
+    int max_speed{1};                   // pixels per time step
+    private:
+        void next_pixel();
+    public:
+        // constructor
+        line_motion();
+        line_motion(int, int, int, int, int max_speed = 1);
+        // functions
+        void start(int, int, int, int, int max_speed = 1);
+        bool step(int&, int&);
+        int emit(trajectory&, int);
+        // getters
+        bool done() const;
+        int get_x() const;
+        int get_y() const;
+};
+
+#endif
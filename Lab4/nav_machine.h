@@ -0,0 +1,39 @@
+// table driven navigation state machine. a controller defines its states and events as small enums
+// and a transition table [state][event] -> next state, nav_machine::stay to ignore the event.
+// the machine counts the steps, entries and controller time of each state, for profiling
+#ifndef NAV_MACHINE
+#define NAV_MACHINE
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+class nav_machine {
+    const uint8_t *table;               // num_states x num_events, row major, owned by the controller
+    const char *const *names;           // state names for the profile, owned by the controller
+    int num_states, num_events;
+    int current;
+    std::vector<uint64_t> steps;        // ticks that ended in each state
+    std::vector<uint64_t> entries;      // transitions into each state
+    std::vector<std::chrono::steady_clock::duration> time;     // time spent in each state
+    std::chrono::steady_clock::time_point mark;                // start of the time not yet counted
+    private:
+        void charge();
+    public:
+        static const uint8_t stay = 255;
+        // constructor
+        nav_machine(const uint8_t *, const char *const *, int, int, int initial = 0);
+        // functions
+        int fire(int);
+        void tick();
+        void restart_clock();
+        void print_profile(std::ostream&) const;
+        // getters
+        int state() const;
+        uint64_t get_steps(int) const;
+        uint64_t get_entries(int) const;
+        double get_seconds(int) const;
+};
+
+#endif
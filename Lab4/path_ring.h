@@ -0,0 +1,37 @@
+// fixed capacity ring of robot positions (top left corners), for the steps the wall follower has
+// committed to. no allocation: the positions live in the ring itself
+#ifndef PATH_RING
+#define PATH_RING
+
+#include <cstddef>
+#include <cstdint>
+#include "trajectory.h"
+
+template <size_t N>
+class path_ring {
+    traj_point slots[N];
+    size_t head{0};                     // slot of the next position
+    size_t count{0};
+    public:
+        // functions
+        void push(int x, int y) {
+            slots[(head + count) % N] = traj_point{(int16_t)x, (int16_t)y};
+            count++;
+        }
+        traj_point pop() {
+            traj_point point = slots[head];
+            head = (head + 1) % N;
+            count--;
+            return point;
+        }
+        void clear() {
+            head = 0;
+            count = 0;
+        }
+        // getters
+        bool empty() const { return count == 0; }
+        size_t size() const { return this->count; }
+        static constexpr size_t capacity() { return N; }
+};
+
+#endif
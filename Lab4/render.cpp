@@ -4,9 +4,11 @@
 #include <random>
 #include <vector>
 #include <chrono>
-#include <map>
+#include <algorithm>
 
 #include "utils.h"
+#include "trajectory.h"
+#include "live.h"
 
 // Text colours
 const std::string RED = "\033[31m";   // Red text
@@ -31,26 +33,72 @@ sf::RectangleShape draw_angled_object(int x, int y, int width, int height, float
     return obj;  
 }
 
+// bake static shapes into one triangle list so the whole scene is a single draw call
+sf::VertexArray bake_scene(const std::vector<sf::RectangleShape> &shapes) {
+    sf::VertexArray scene(sf::Triangles);
+    for (const sf::RectangleShape &shape: shapes) {
+        const sf::Transform &transform = shape.getTransform();
+        sf::Vector2f corner[4];
+        for (int k = 0; k < 4; k++) {
+            corner[k] = transform.transformPoint(shape.getPoint(k));
+        }
+        // two triangles per rectangle: 0-1-2 and 0-2-3
+        const int order[6] = {0, 1, 2, 0, 2, 3};
+        for (int k: order) {
+            scene.append(sf::Vertex(corner[k], shape.getFillColor()));
+        }
+    }
+    return scene;
+}
+
+// the walls as one baked scene
+sf::VertexArray bake_objects(std::vector<Object *> &objects) {
+    std::vector<sf::RectangleShape> objects_draw;
+    bool is_angled = (dynamic_cast<Wall*>(objects[0]))? true: false;
+    for (int i = 0; i < objects.size(); i++) {
+        if (!is_angled) {
+            objects_draw.push_back(draw_object(objects[i]->x, objects[i]->y, objects[i]->width, objects[i]->height));
+        }
+        else {
+            Wall* wall = dynamic_cast<Wall*>(objects[i]);
+            objects_draw.push_back(draw_angled_object(
+                wall->x, wall->y, wall->width, wall->height, wall->angle));
+        }
+    }
+    return bake_scene(objects_draw);
+}
+
+const int scrub_bar_height = 8;                 // bar along the bottom edge of the window
+
+// scrub bar along the bottom of the window, filled up to the current step
+void draw_scrub_bar(sf::RenderWindow &window, int step, int num_steps) {
+    float width = window.getSize().x;
+    float top = window.getSize().y - scrub_bar_height;
+    sf::RectangleShape bar(sf::Vector2f(width, scrub_bar_height));
+    bar.setPosition(0, top);
+    bar.setFillColor(sf::Color(0, 0, 0, 96));
+    window.draw(bar);
+    sf::RectangleShape progress(sf::Vector2f(width*step/std::max(num_steps - 1, 1), scrub_bar_height));
+    progress.setPosition(0, top);
+    progress.setFillColor(sf::Color(255, 140, 0));
+    window.draw(progress);
+}
+
 // draw
 void draw(
     sf::RenderWindow &window,
     sf::CircleShape &robot_draw,
     sf::Vector2f &robotPosition,
-    std::vector<sf::RectangleShape> &objects_draw,
-    std::vector<std::vector<int>> &robot_pos,
-    std::vector<sf::RectangleShape>::iterator &i,
+    sf::VertexArray &scene,
+    const trajectory &robot_pos,
     bool &isPaused,
-    int &count
+    int &count,
+    int &steps_per_frame
 ) {
-    if (count < robot_pos.size() && robot_pos[count].size() >= 2) {
-        robotPosition.x = robot_pos[count][0]; // Safe access
-        robotPosition.y = robot_pos[count][1]; // Safe access
-    } else {
-        if (count < 200) {
-            std::cerr << "Error: Accessing out of bounds for robot_pos at count: " << count << std::endl;
-            // Handle error appropriately (e.g., skip iteration, set defaults, etc.)
-        }
-    }
+    int num_steps = robot_pos.size();
+    int step = std::min(count, num_steps - 1);
+    robotPosition.x = robot_pos[step].x;
+    robotPosition.y = robot_pos[step].y;
 
     // clear the window
     window.clear(sf::Color::White);
@@ -59,11 +107,11 @@ void draw(
     robot_draw.setPosition(robotPosition);
     window.draw(robot_draw);
     // window.draw(line);
-    for (i = objects_draw.begin(); i != objects_draw.end(); ++i){
-        window.draw(*i);
-    }
+    window.draw(scene);
+    draw_scrub_bar(window, step, num_steps);
 
-    if (count >= robot_pos.size()-1) {
+    // close once playback runs to the end; while paused the end can be looked at
+    if (count >= num_steps - 1 && !isPaused) {
         std::cout << "==========Ground-truth window terminated==========" << std::endl;
         window.close();
     }
@@ -71,75 +119,124 @@ void draw(
     // end the current frame
     window.display();
 
-    // increment only if not paused
+    // advance only if not paused, steps_per_frame steps at a time
     if (!isPaused) {
-        count++;
+        count = std::min(count + steps_per_frame, num_steps - 1);
     }
 }
 
-void check_keypress (
-    std::chrono::steady_clock::time_point &prev_pause,
-    int64_t &elapsed_pause,
-    std::chrono::steady_clock::time_point &prev_left, std::chrono::steady_clock::time_point &prev_right,
-    int64_t &elapsed_left, int64_t &elapsed_right,
-    int &count, int &left_count, int &right_count, bool &isPaused,
+// playback position and the state of the keyboard/mouse controls of a window
+struct playback {
+    int count{0};                               // step shown
+    bool isPaused{false};                       // State to track whether the game is paused
+    std::string seek_input;                     // digits typed so far for a seek
+    sf::Keyboard::Key last_key{sf::Keyboard::Unknown};
+    int repeats{0};                             // key repeats of last_key, for acceleration
+    std::chrono::steady_clock::time_point last_press;
+    bool scrubbing{false};                      // mouse held down on the scrub bar
+};
+
+const int jump_steps = 100;                     // steps per up/down press
+
+void seek_to(playback &play, int step, int num_steps) {
+    play.count = std::max(0, std::min(step, num_steps - 1));
+}
+
+void set_title(playback &play, sf::RenderWindow &window, std::string &title) {
+    if (play.isPaused) {
+        window.setTitle("PAUSED. p: unpause, left/right: step, up/down: jump, home/end: start/end, digits + enter: seek.");
+    }
+    else {
+        window.setTitle(title);
+    }
+}
+
+// keyboard and mouse controls, handled as events:
+// p pauses, left/right step (faster the longer the key is held), up/down jump by jump_steps,
+// home/end go to the start/end, typing a step number and pressing enter seeks to it, and
+// clicking or dragging on the scrub bar seeks to that point of the run
+void check_event(
+    sf::Event &event,
+    playback &play,
     sf::RenderWindow &window,
-    std::vector<std::vector<int>> &robot_pos,
+    const trajectory &robot_pos,
     std::string &title
 ) {
-
-    // check for pausing. press p to pause
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::P)) {
-        elapsed_pause = std::chrono::duration_cast<std::chrono::milliseconds>
-            (std::chrono::steady_clock::now() - prev_pause).count();
-        prev_pause = std::chrono::steady_clock::now();
-        if (elapsed_pause > 200) {
-            isPaused = !isPaused;
-            if (isPaused) {
-                window.setTitle("PAUSED. Press p to unpause. Press left/right keys to move back/forward in time.");
-                // std::cout << "PAUSED. Press p to unpause" << std::endl;
-            }
-            else {
-                window.setTitle(title);
-                // std::cout << "UNPAUSED" << std::endl;
-            }
-        }
+    int num_steps = robot_pos.size();
+    int bar_top = static_cast<int>(window.getSize().y) - scrub_bar_height;
+    int bar_width = std::max(static_cast<int>(window.getSize().x) - 1, 1);
+
+    if (event.type == sf::Event::TextEntered && event.text.unicode >= '0' && event.text.unicode <= '9'
+        && play.seek_input.size() < 9) {
+        play.seek_input += static_cast<char>(event.text.unicode);
+        window.setTitle("Seek to step " + play.seek_input + " of " + std::to_string(num_steps-1)
+            + ". Press enter to jump, escape to cancel.");
     }
-
-    // check for left key for rewind
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
-        elapsed_left = std::chrono::duration_cast<std::chrono::milliseconds>
-            (std::chrono::steady_clock::now() - prev_left).count();
-        prev_left = std::chrono::steady_clock::now();
-        left_count++;
-        // originally 10, lowered to account higher fps
-        if (elapsed_left > 3) {
-            if (isPaused && (count >= 1)) {
-                // std::cout << "Moving back " << left_count << " timesteps" << std::endl;
-                left_count = 0;
-                count--;
-            }
+    else if (event.type == sf::Event::KeyPressed) {
+        // held keys send repeated presses: step further the longer the key is held
+        auto now = std::chrono::steady_clock::now();
+        if (event.key.code == play.last_key && now - play.last_press < std::chrono::milliseconds(150)) {
+            play.repeats++;
         }
-    }
-
-    // check for right key for forward
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
-        elapsed_right = std::chrono::duration_cast<std::chrono::milliseconds>
-            (std::chrono::steady_clock::now() - prev_right).count();
-        prev_right = std::chrono::steady_clock::now();
-        right_count++;
-        if (elapsed_right > 3) {
-            if (isPaused && (count <= robot_pos.size())) {
-                // std::cout << "Moving back " << left_count << " timesteps" << std::endl;
-                right_count = 0;
-                count++;
-            }
+        else {
+            play.repeats = 0;
         }
+        play.last_key = event.key.code;
+        play.last_press = now;
+        int step = 1 << std::min(play.repeats / 10, 8);
+
+        switch (event.key.code) {
+            case sf::Keyboard::Enter:
+            case sf::Keyboard::Escape:
+                if (!play.seek_input.empty()) {
+                    if (event.key.code == sf::Keyboard::Enter) {
+                        seek_to(play, std::stoi(play.seek_input), num_steps);
+                    }
+                    play.seek_input.clear();
+                    set_title(play, window, title);
+                }
+                break;
+            case sf::Keyboard::P:
+                play.isPaused = !play.isPaused;
+                set_title(play, window, title);
+                break;
+            case sf::Keyboard::Left:
+                seek_to(play, play.count - step, num_steps);
+                break;
+            case sf::Keyboard::Right:
+                seek_to(play, play.count + step, num_steps);
+                break;
+            case sf::Keyboard::Down:
+                seek_to(play, play.count - jump_steps, num_steps);
+                break;
+            case sf::Keyboard::Up:
+                seek_to(play, play.count + jump_steps, num_steps);
+                break;
+            case sf::Keyboard::Home:
+                seek_to(play, 0, num_steps);
+                break;
+            case sf::Keyboard::End:
+                seek_to(play, num_steps - 1, num_steps);
+                break;
+            default:
+                break;
+        }
+    }
+    else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left
+        && event.mouseButton.y >= bar_top) {
+        play.scrubbing = true;
+        seek_to(play, static_cast<int>(static_cast<int64_t>(event.mouseButton.x)*(num_steps-1)/bar_width), num_steps);
+    }
+    else if (event.type == sf::Event::MouseMoved && play.scrubbing) {
+        seek_to(play, static_cast<int>(static_cast<int64_t>(event.mouseMove.x)*(num_steps-1)/bar_width), num_steps);
+    }
+    else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left) {
+        play.scrubbing = false;
     }
 }
 
 void render_window(
-    std::vector<std::vector<int>> &robot_pos,
+    const trajectory &robot_pos,
     std::vector<Object *> &objects,
     Object robot, 
     int width, 
@@ -159,7 +256,9 @@ void render_window(
     // create the window
     std::string title = "MTE301 Lab 4 Ground Truth Map at " + std::to_string(render_speed) + "x Speed";
     sf::RenderWindow window(sf::VideoMode(width, height), title);
-    window.setFramerateLimit(60*render_speed);
+    // frames stay at 60 fps, faster playback advances more steps per frame
+    window.setFramerateLimit(60);
+    int steps_per_frame = std::max(render_speed, 1);
     window.setPosition(sf::Vector2i(top_left_x, top_left_y));
     window.clear(sf::Color::White);
 
@@ -169,37 +268,10 @@ void render_window(
     sf::Vector2f robotPosition(robot.x, robot.y);
     robot_draw.setPosition(robotPosition);
   
-    std::vector<sf::RectangleShape> objects_draw;
-    // is it an angled wall (Wall) or a regular wall (Object)?
-    // bool is_angled = objects[0]->type() == 1? true: false;
-    bool is_angled = (dynamic_cast<Wall*>(objects[0]))? true: false;
-    for (int i = 0; i < objects.size(); i++) {
-        if (!is_angled) {
-            objects_draw.push_back(draw_object(objects[i]->x, objects[i]->y, objects[i]->width, objects[i]->height));
-        }
-        else {
-            Wall* wall = dynamic_cast<Wall*>(objects[i]);
-            objects_draw.push_back(draw_angled_object(
-                wall->x, wall->y, wall->width, wall->height, wall->angle));
-        }
-    }
+    sf::VertexArray scene = bake_objects(objects);
 
-    std::vector<sf::RectangleShape>::iterator i;
-    int count = 0;
-    bool isPaused{false}; // State to track whether the game is paused
-    int left_count{0}; // counter for how many times left was pressed
-    int right_count{0}; // counter for how many times right was pressed
-
-    // timers for button press events
-    auto prev_pause = std::chrono::steady_clock::now();
-    auto elapsed_pause = std::chrono::duration_cast<std::chrono::milliseconds>
-        (std::chrono::steady_clock::now() - prev_pause).count();
-    auto prev_left = std::chrono::steady_clock::now();
-    auto elapsed_left = std::chrono::duration_cast<std::chrono::milliseconds>
-        (std::chrono::steady_clock::now() - prev_left).count();
-    auto prev_right = std::chrono::steady_clock::now();
-    auto elapsed_right = std::chrono::duration_cast<std::chrono::milliseconds>
-        (std::chrono::steady_clock::now() - prev_right).count();
+    // playback position and controls
+    playback play;
 
     //==========Main loop==========
     while (window.isOpen())
@@ -214,85 +286,187 @@ void render_window(
                 std::cout << "==========Ground-truth window terminated==========" << std::endl;
                 window.close();
             }
+            check_event(event, play, window, robot_pos, title);
         }
 
-        check_keypress (prev_pause, elapsed_pause, 
-            prev_left, prev_right, 
-            elapsed_left, elapsed_right,
-            count, left_count,right_count, 
-            isPaused, window, robot_pos, title);
-
-        draw(window, robot_draw, robotPosition, objects_draw, robot_pos, i, isPaused, count);
+        draw(window, robot_draw, robotPosition, scene, robot_pos, play.isPaused, play.count, steps_per_frame);
         
     }
 }
 
+// paint the whole map as unknown
+void clear_map(std::vector<sf::Uint8> &mapPixels, const sf::Color &unknown) {
+    for (size_t p = 0; p < mapPixels.size(); p += 4) {
+        mapPixels[p] = unknown.r;
+        mapPixels[p+1] = unknown.g;
+        mapPixels[p+2] = unknown.b;
+        mapPixels[p+3] = unknown.a;
+    }
+}
+
+// the map every snapshot_interval steps, so a seek restores the closest snapshot at or before its
+// step and reveals at most snapshot_interval - 1 steps from there, instead of the whole run again.
+// the map only holds the grid_cell colours, so a snapshot keeps one index into them per pixel
+const int snapshot_interval = 256;
+
+std::vector<uint8_t> take_snapshot(const std::vector<sf::Uint8> &mapPixels, const sf::Color *grid_cell) {
+    std::vector<uint8_t> snapshot(mapPixels.size() / 4, 0);
+    for (size_t p = 0; p < snapshot.size(); p++) {
+        const sf::Uint8 *pixel = &mapPixels[4*p];
+        for (uint8_t k = 1; k < 3; k++) {
+            if (pixel[0] == grid_cell[k].r && pixel[1] == grid_cell[k].g && pixel[2] == grid_cell[k].b) {
+                snapshot[p] = k;
+            }
+        }
+    }
+    return snapshot;
+}
+
+void restore_snapshot(std::vector<sf::Uint8> &mapPixels, const std::vector<uint8_t> &snapshot, const sf::Color *grid_cell) {
+    for (size_t p = 0; p < snapshot.size(); p++) {
+        const sf::Color &colour = grid_cell[snapshot[p]];
+        sf::Uint8 *pixel = &mapPixels[4*p];
+        pixel[0] = colour.r;
+        pixel[1] = colour.g;
+        pixel[2] = colour.b;
+        pixel[3] = colour.a;
+    }
+}
+
+// colour the map pixels within the LiDAR radius of (c_x, c_y) and grow the dirty rectangle to cover them
+void reveal_disc(
+    std::vector<sf::Uint8> &mapPixels,
+    std::vector<std::vector<int>> &r_grid,
+    const sf::Color *grid_cell,
+    int c_x, int c_y, int LIDAR_RADIUS, int width, int height,
+    int &x_min, int &x_max, int &y_min, int &y_max) {
+
+    int d_x_min = std::max(0, c_x - LIDAR_RADIUS);
+    int d_x_max = std::min(width - 1, c_x + LIDAR_RADIUS);
+    int d_y_min = std::max(0, c_y - LIDAR_RADIUS);
+    int d_y_max = std::min(height - 1, c_y + LIDAR_RADIUS);
+    for (int x = d_x_min; x < d_x_max; ++x) {
+        for (int y = d_y_min; y < d_y_max; ++y) {
+            // Check if the point is within the LiDAR radius
+            if ((x - c_x) * (x - c_x) + (y - c_y) * (y - c_y) <= LIDAR_RADIUS * LIDAR_RADIUS) {
+                // grid values are -1 (unknown) to 1, so the colour table is offset by one
+                const sf::Color &colour = grid_cell[std::min(std::max(r_grid[x][y], -1), 1) + 1];
+                sf::Uint8 *pixel = &mapPixels[4*(y*width + x)];
+                pixel[0] = colour.r;
+                pixel[1] = colour.g;
+                pixel[2] = colour.b;
+                pixel[3] = colour.a;
+            }
+        }
+    }
+    x_min = std::min(x_min, d_x_min);
+    x_max = std::max(x_max, d_x_max);
+    y_min = std::min(y_min, d_y_min);
+    y_max = std::max(y_max, d_y_max);
+}
+
+// colour the diff layer (see grid_util::diff_map) for drawing over the map: false walls red, missed
+// walls magenta, unknown cells blue, correct and outside cells clear. empty if there is no diff
+void make_diff_texture(sf::Texture &diffTexture, const std::vector<uint8_t> &diff, int width, int height) {
+    if (diff.size() != (size_t)width*height) {
+        return;
+    }
+    const sf::Color diff_cell[5] = {sf::Color::Transparent,
+                                    sf::Color(255, 0, 0, 200),
+                                    sf::Color(255, 0, 255, 200),
+                                    sf::Color(0, 120, 255, 110),
+                                    sf::Color::Transparent};
+    std::vector<sf::Uint8> diffPixels(4*width*height);
+    for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y) {
+            const sf::Color &colour = diff_cell[std::min<int>(diff[x*height + y], 4)];
+            sf::Uint8 *pixel = &diffPixels[4*(y*width + x)];
+            pixel[0] = colour.r;
+            pixel[1] = colour.g;
+            pixel[2] = colour.b;
+            pixel[3] = colour.a;
+        }
+    }
+    diffTexture.create(width, height);
+    diffTexture.update(diffPixels.data());
+}
+
+// bring the map texture up to step: colour the map around every position the robot left since the
+// last frame, including the steps skipped between frames. only the dirty rectangle is uploaded. a
+// seek backwards, or forwards past a snapshot taken earlier, starts from the closest snapshot
+void update_map(
+    const trajectory &robot_pos,
+    std::vector<std::vector<int>> &r_grid,
+    sf::Texture &mapTexture,
+    std::vector<sf::Uint8> &mapPixels,
+    std::vector<sf::Uint8> &rectPixels,
+    const sf::Color *grid_cell,
+    std::vector<std::vector<uint8_t>> &snapshots,
+    int &revealed, int step,
+    int radius, int LIDAR_RADIUS, int width, int height) {
+
+    int k = std::min<int>(step / snapshot_interval, (int)snapshots.size() - 1);
+    if (k >= 0 && (step < revealed || k*snapshot_interval > revealed)) {
+        restore_snapshot(mapPixels, snapshots[k], grid_cell);
+        mapTexture.update(mapPixels.data());
+        revealed = k*snapshot_interval;
+    }
+    int x_min = width, x_max = 0, y_min = height, y_max = 0;
+    for (; revealed < step; revealed++) {
+        if (revealed == (int)snapshots.size()*snapshot_interval) {
+            snapshots.push_back(take_snapshot(mapPixels, grid_cell));
+        }
+        // the robot often stays put for a step; its disc is already coloured then
+        if (revealed > 0 && robot_pos[revealed].x == robot_pos[revealed-1].x
+            && robot_pos[revealed].y == robot_pos[revealed-1].y) {
+            continue;
+        }
+        reveal_disc(mapPixels, r_grid, grid_cell,
+            robot_pos[revealed].x+radius, robot_pos[revealed].y+radius, LIDAR_RADIUS, width, height,
+            x_min, x_max, y_min, y_max);
+    }
+    if (x_min < x_max && y_min < y_max) {
+        // the texture wants the rectangle's pixels contiguous, so copy its rows out first
+        int rect_width = x_max - x_min;
+        int rect_height = y_max - y_min;
+        rectPixels.resize(4*rect_width*rect_height);
+        for (int y = y_min; y < y_max; ++y) {
+            std::copy_n(&mapPixels[4*(y*width + x_min)], 4*rect_width, &rectPixels[4*(y - y_min)*rect_width]);
+        }
+        mapTexture.update(rectPixels.data(), rect_width, rect_height, x_min, y_min);
+    }
+}
+
 void draw_grid(
     sf::RenderWindow &window,
-    std::vector<std::vector<int>> &robot_pos,
+    const trajectory &robot_pos,
     std::vector<std::vector<int>> &r_grid,
     sf::CircleShape &robot,
     sf::CircleShape &lidar,
-    sf::Image &freeSpaceImage,
-    sf::Texture &freeSpaceTexture,
-    std::map<int, sf::Color> &grid_cell,
-    sf::Vector2f &robotPosition, sf::Vector2f &prevRobotPos,
-    int &x_min, int &x_max, int &y_min, int &y_max, int &count, 
+    sf::Texture &mapTexture,
+    sf::Sprite &mapSprite,
+    const sf::Sprite *diffSprite,
+    std::vector<sf::Uint8> &mapPixels,
+    std::vector<sf::Uint8> &rectPixels,
+    const sf::Color *grid_cell,
+    sf::Vector2f &robotPosition,
+    std::vector<std::vector<uint8_t>> &snapshots,
+    int &revealed, int &count, int &steps_per_frame,
     int &radius, int &LIDAR_RADIUS, int &width, int &height,
     bool &isPaused) {
 
-    if (count < robot_pos.size() && robot_pos[count].size() >= 2) {
-        // add radius to account for the offset between corner and center
-        robotPosition.x = robot_pos[count][0]+radius; // Safe access
-        robotPosition.y = robot_pos[count][1]+radius; // Safe access
-    } else {
-        if (count < 200) {
-            std::cerr << "Error: Accessing out of bounds for robot_pos at count: " << count << std::endl;
-            // Handle error appropriately (e.g., skip iteration, set defaults, etc.)
-        }
-    }
+    int num_steps = robot_pos.size();
+    int step = std::min(count, num_steps - 1);
+    // add radius to account for the offset between corner and center
+    robotPosition.x = robot_pos[step].x+radius;
+    robotPosition.y = robot_pos[step].y+radius;
 
     // drawing operations
     robot.setPosition(robotPosition);
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-    // update the portion of the screen the robot left behind
-    if (robotPosition != prevRobotPos) {
-
-        x_min = std::max(0, static_cast<int>(prevRobotPos.x - LIDAR_RADIUS));
-        x_max = std::min(width - 1, static_cast<int>(prevRobotPos.x + LIDAR_RADIUS));
-        y_min = std::max(0, static_cast<int>(prevRobotPos.y - LIDAR_RADIUS));
-        y_max = std::min(height - 1, static_cast<int>(prevRobotPos.y + LIDAR_RADIUS));
-
-        freeSpaceImage.create(2*LIDAR_RADIUS, 2*LIDAR_RADIUS, sf::Color::Transparent);
-        
-        // Loop over the bounding box and mark pixels as white if they are within the LiDAR radius
-        for (int x = x_min; x < x_max; ++x) {
-            for (int y = y_min; y < y_max; ++y) {
-                // Check if the point is within the LiDAR radius
-                if ((x - prevRobotPos.x) * (x - prevRobotPos.x) +
-                    (y - prevRobotPos.y) * (y - prevRobotPos.y) <= LIDAR_RADIUS * LIDAR_RADIUS) {
-                        // freeSpaceImage.setPixel(x - x_min, y - y_min, sf::Color::White); // Mark as free space (white)
-                        freeSpaceImage.setPixel(x - x_min, y - y_min, grid_cell[r_grid[x][y]]);
-                }
-            }
-        }
-
-        // convert the Image to a Texture
-        freeSpaceTexture.loadFromImage(freeSpaceImage);
-
-        // convert the Texture to a Sprite
-        sf::Sprite freeSpaceSprite(freeSpaceTexture);
-        // this is top-left position. Subtract 10 to account for LiDAR range
-        freeSpaceSprite.setPosition(x_min, y_min);
-
-        // Draw the free space onto the window
-        window.draw(freeSpaceSprite);
-
-        // Update the previous position
-        prevRobotPos = robotPosition;
-
-    }
+    update_map(robot_pos, r_grid, mapTexture, mapPixels, rectPixels, grid_cell,
+        snapshots, revealed, step, radius, LIDAR_RADIUS, width, height);
 
     // // update the LiDAR circle to follow the robot
     // lidar.setPosition(robot.getPosition());
@@ -300,26 +474,33 @@ void draw_grid(
     // // draw the LiDAR circle and the robot without clearing the window
     // window.draw(lidar);
 
-    // draw the robot
+    // draw the map, the diff layer if shown, the robot and the scrub bar
+    window.clear();
+    window.draw(mapSprite);
+    if (diffSprite != nullptr) {
+        window.draw(*diffSprite);
+    }
     window.draw(robot);
+    draw_scrub_bar(window, step, num_steps);
 
     window.display();
 
-    if (count == robot_pos.size()-1) {
-        std::cout << "==========Occupancy grid mapping stopped after " << robot_pos.size() << " iterations==========" << std::endl;
-    }
-
-    // increment only if not paused
-    if (!isPaused) {
-        count++;
+    // advance only if not paused, steps_per_frame steps at a time
+    if (!isPaused && count < num_steps - 1) {
+        count = std::min(count + steps_per_frame, num_steps - 1);
+        if (count == num_steps - 1) {
+            std::cout << "==========Occupancy grid mapping stopped after " << robot_pos.size() << " iterations==========" << std::endl;
+        }
     }
 
 }
 
+// d shows the diff of the final map against the truth over the map, if one is given
 void render_grid(Object robot_,
-    std::vector<std::vector<int>> robot_pos, 
+    const trajectory &robot_pos, 
     std::vector<std::vector<int>> r_grid,
-    int width, int height, int radius, int l_radius, int render_speed) {
+    int width, int height, int radius, int l_radius, int render_speed,
+    const std::vector<uint8_t> &diff) {
 
     // retrieve screen resolution to center the window
     sf::VideoMode desktop = sf::VideoMode::getDesktopMode();
@@ -330,15 +511,17 @@ void render_grid(Object robot_,
     // create the window
     std::string title = "MTE301 Lab 4 Occupancy Grid Map at " + std::to_string(render_speed) + "x Speed";
     sf::RenderWindow window(sf::VideoMode(width, height), title);
-    window.setFramerateLimit(60*render_speed);
+    // frames stay at 60 fps, faster playback advances more steps per frame
+    window.setFramerateLimit(60);
+    int steps_per_frame = std::max(render_speed, 1);
     window.setPosition(sf::Vector2i(top_left_x, top_left_y));
     window.clear(sf::Color(128, 128, 128));
     window.display();
 
-    // map for key-value pair between occupancy and grid cell colour
-    std::map<int, sf::Color> grid_cell = {{0, sf::Color::White}, 
-                                        {1, sf::Color::Black}, 
-                                        {-1, sf::Color(128, 128, 128)}};
+    // lookup table between occupancy (-1 to 1, offset by one) and grid cell colour
+    const sf::Color grid_cell[3] = {sf::Color(128, 128, 128),
+                                    sf::Color::White,
+                                    sf::Color::Black};
 
     // Robot circle shape
     sf::CircleShape robot(radius);
@@ -353,34 +536,29 @@ void render_grid(Object robot_,
     lidar.setOrigin(l_radius, l_radius); // Set origin to the center
     lidar.setPosition(robot.getPosition()); // Initially place the LiDAR circle on the robot
 
-    // previous robot position to track where it left
-    sf::Vector2f prevRobotPos = robot.getPosition();
-    int count = 0;
-
-    // variables for handling key events
-    bool isPaused{false}; // State to track whether the game is paused
-    int left_count{0}; // counter for how many times left was pressed
-    int right_count{0}; // counter for how many times right was pressed
-
-    // timers for button press events
-    auto prev_pause = std::chrono::steady_clock::now();
-    auto elapsed_pause = std::chrono::duration_cast<std::chrono::milliseconds>
-        (std::chrono::steady_clock::now() - prev_pause).count();
-    auto prev_left = std::chrono::steady_clock::now();
-    auto elapsed_left = std::chrono::duration_cast<std::chrono::milliseconds>
-        (std::chrono::steady_clock::now() - prev_left).count();
-    auto prev_right = std::chrono::steady_clock::now();
-    auto elapsed_right = std::chrono::duration_cast<std::chrono::milliseconds>
-        (std::chrono::steady_clock::now() - prev_right).count();
-
-    // create an sf::Image to manually set pixels
-    sf::Image freeSpaceImage;
-    // convert the Image to a Texture
-    sf::Texture freeSpaceTexture;
-
-    // define min/max for bounding box of lidar circle in previous frame
-    int x_min, x_max, y_min, y_max;
-    
+    // steps whose LiDAR disc is coloured in the map so far, and the map every snapshot_interval steps
+    int revealed = 0;
+    std::vector<std::vector<uint8_t>> snapshots;
+
+    // playback position and controls
+    playback play;
+
+    // persistent full size map texture, starting out unknown (grey). mapPixels mirrors it as RGBA
+    // so each frame only the dirty rectangle around the robot is recoloured and uploaded
+    std::vector<sf::Uint8> mapPixels(4*width*height);
+    clear_map(mapPixels, grid_cell[0]);
+    std::vector<sf::Uint8> rectPixels;
+    sf::Texture mapTexture;
+    mapTexture.create(width, height);
+    mapTexture.update(mapPixels.data());
+    sf::Sprite mapSprite(mapTexture);
+
+    // diff of the final map, drawn over the map while toggled on
+    sf::Texture diffTexture;
+    make_diff_texture(diffTexture, diff, width, height);
+    sf::Sprite diffSprite(diffTexture);
+    bool show_diff = false;
+
     // main loop
     while (window.isOpen()) {
         // count++;
@@ -389,20 +567,401 @@ void render_grid(Object robot_,
             if (event.type == sf::Event::Closed) {
                 window.close();
             }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::D && !diff.empty()) {
+                show_diff = !show_diff;
+            }
+            check_event(event, play, window, robot_pos, title);
         }
 
-        check_keypress (prev_pause, elapsed_pause, 
-            prev_left, prev_right, 
-            elapsed_left, elapsed_right,
-            count, left_count,right_count, 
-            isPaused, window, robot_pos, title);
-
         draw_grid(window, robot_pos, r_grid, robot, lidar, 
-            freeSpaceImage, freeSpaceTexture,
+            mapTexture, mapSprite, show_diff ? &diffSprite : nullptr, mapPixels, rectPixels,
             grid_cell,
-            robotPosition, prevRobotPos,
-            x_min, x_max, y_min, y_max, count, 
-            radius, l_radius, width, height, isPaused);
+            robotPosition,
+            snapshots, revealed, play.count, steps_per_frame,
+            radius, l_radius, width, height, play.isPaused);
+
+    }
+}
+
+// ground truth and occupancy grid side by side in one window, driven by one playback clock, so the
+// run is played back once instead of once per window. o overlays the true walls (red) on the
+// robot's map: red over black is a mapped wall, red over white or grey a missed one. d shows the
+// diff of the final map, as in render_grid
+void render_split(
+    const trajectory &robot_pos,
+    std::vector<Object *> &objects,
+    std::vector<std::vector<int>> r_grid,
+    int width, int height, int radius, int l_radius, int render_speed,
+    const std::vector<uint8_t> &diff) {
+
+    // retrieve screen resolution to center the window
+    sf::VideoMode desktop = sf::VideoMode::getDesktopMode();
+
+    int top_left_x = (desktop.width/2) - width;
+    int top_left_y = (desktop.height/2) - (height/2);
+
+    // create the window, truth on the left and the robot's map on the right
+    std::string title = "MTE301 Lab 4 Ground Truth | Occupancy Grid Map at " + std::to_string(render_speed) + "x Speed";
+    sf::RenderWindow window(sf::VideoMode(2*width, height), title);
+    // frames stay at 60 fps, faster playback advances more steps per frame
+    window.setFramerateLimit(60);
+    int steps_per_frame = std::max(render_speed, 1);
+    window.setPosition(sf::Vector2i(top_left_x, top_left_y));
+
+    // both panels show the environment's coordinates, each on its half of the window
+    sf::View truthView(sf::FloatRect(0, 0, width, height));
+    truthView.setViewport(sf::FloatRect(0, 0, 0.5f, 1));
+    sf::View mapView(sf::FloatRect(0, 0, width, height));
+    mapView.setViewport(sf::FloatRect(0.5f, 0, 0.5f, 1));
+
+    // lookup table between occupancy (-1 to 1, offset by one) and grid cell colour
+    const sf::Color grid_cell[3] = {sf::Color(128, 128, 128),
+                                    sf::Color::White,
+                                    sf::Color::Black};
+
+    // ground truth walls, and the same walls in translucent red for the overlay
+    sf::VertexArray scene = bake_objects(objects);
+    sf::VertexArray overlay = scene;
+    for (size_t v = 0; v < overlay.getVertexCount(); v++) {
+        overlay[v].color = sf::Color(255, 0, 0, 128);
+    }
+    bool show_overlay = false;
+
+    // diff of the final map
+    sf::Texture diffTexture;
+    make_diff_texture(diffTexture, diff, width, height);
+    sf::Sprite diffSprite(diffTexture);
+    bool show_diff = false;
+
+    // the robot in each panel, placed by its corner like the logged positions
+    sf::CircleShape truthRobot(radius);
+    truthRobot.setFillColor(sf::Color::Green);
+    sf::CircleShape mapRobot(radius);
+    mapRobot.setFillColor(sf::Color::Green);
+
+    // persistent map texture, as in render_grid
+    std::vector<sf::Uint8> mapPixels(4*width*height);
+    clear_map(mapPixels, grid_cell[0]);
+    std::vector<sf::Uint8> rectPixels;
+    sf::Texture mapTexture;
+    mapTexture.create(width, height);
+    mapTexture.update(mapPixels.data());
+    sf::Sprite mapSprite(mapTexture);
+    int revealed = 0;
+    std::vector<std::vector<uint8_t>> snapshots;
+
+    // playback position and controls, shared by both panels
+    playback play;
+    int num_steps = robot_pos.size();
+
+    // main loop
+    while (window.isOpen()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                window.close();
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::O) {
+                show_overlay = !show_overlay;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::D && !diff.empty()) {
+                show_diff = !show_diff;
+            }
+            check_event(event, play, window, robot_pos, title);
+        }
+
+        int step = std::min(play.count, num_steps - 1);
+        truthRobot.setPosition(robot_pos[step].x, robot_pos[step].y);
+        mapRobot.setPosition(robot_pos[step].x, robot_pos[step].y);
+        update_map(robot_pos, r_grid, mapTexture, mapPixels, rectPixels, grid_cell,
+            snapshots, revealed, step, radius, l_radius, width, height);
+
+        window.clear(sf::Color::White);
+        window.setView(truthView);
+        window.draw(scene);
+        window.draw(truthRobot);
+        window.setView(mapView);
+        window.draw(mapSprite);
+        if (show_diff) {
+            window.draw(diffSprite);
+        }
+        if (show_overlay) {
+            window.draw(overlay);
+        }
+        window.draw(mapRobot);
+        // the scrub bar spans the whole window
+        window.setView(window.getDefaultView());
+        draw_scrub_bar(window, step, num_steps);
+        window.display();
+
+        // advance only if not paused, steps_per_frame steps at a time
+        if (!play.isPaused && play.count < num_steps - 1) {
+            play.count = std::min(play.count + steps_per_frame, num_steps - 1);
+            if (play.count == num_steps - 1) {
+                std::cout << "==========Playback finished after " << robot_pos.size() << " iterations==========" << std::endl;
+            }
+        }
+    }
+}
+
+
+//==========OFFSCREEN FRAMES==========
+// for machines without a display: frames are rasterized in software into an RGBA buffer (no
+// window or OpenGL context is created) and written as PNG with sf::Image
+
+// fill the pixels whose centers lie inside triangle abc
+void raster_triangle(std::vector<sf::Uint8> &pixels, int width, int height,
+    sf::Vector2f a, sf::Vector2f b, sf::Vector2f c, const sf::Color &colour) {
+
+    // edge function: which side of p0-p1 the point p is on
+    auto edge = [](const sf::Vector2f &p0, const sf::Vector2f &p1, float x, float y) {
+        return (p1.x - p0.x)*(y - p0.y) - (p1.y - p0.y)*(x - p0.x);
+    };
+    float area = edge(a, b, c.x, c.y);
+    if (area == 0) {
+        return;
+    }
+    int x_min = std::max(0, (int)std::floor(std::min({a.x, b.x, c.x})));
+    int x_max = std::min(width - 1, (int)std::ceil(std::max({a.x, b.x, c.x})));
+    int y_min = std::max(0, (int)std::floor(std::min({a.y, b.y, c.y})));
+    int y_max = std::min(height - 1, (int)std::ceil(std::max({a.y, b.y, c.y})));
+    for (int y = y_min; y <= y_max; ++y) {
+        for (int x = x_min; x <= x_max; ++x) {
+            // inside if all three edge functions have the sign of the triangle's area
+            float w0 = edge(b, c, x + 0.5f, y + 0.5f);
+            float w1 = edge(c, a, x + 0.5f, y + 0.5f);
+            float w2 = edge(a, b, x + 0.5f, y + 0.5f);
+            if ((area > 0 && w0 >= 0 && w1 >= 0 && w2 >= 0) || (area < 0 && w0 <= 0 && w1 <= 0 && w2 <= 0)) {
+                sf::Uint8 *pixel = &pixels[4*(y*width + x)];
+                pixel[0] = colour.r;
+                pixel[1] = colour.g;
+                pixel[2] = colour.b;
+                pixel[3] = colour.a;
+            }
+        }
+    }
+}
+
+// fill a disc of radius r centered on (c_x, c_y)
+void raster_disc(std::vector<sf::Uint8> &pixels, int width, int height,
+    int c_x, int c_y, int r, const sf::Color &colour) {
+
+    for (int y = std::max(0, c_y - r); y < std::min(height, c_y + r); ++y) {
+        for (int x = std::max(0, c_x - r); x < std::min(width, c_x + r); ++x) {
+            if ((x - c_x)*(x - c_x) + (y - c_y)*(y - c_y) <= r*r) {
+                sf::Uint8 *pixel = &pixels[4*(y*width + x)];
+                pixel[0] = colour.r;
+                pixel[1] = colour.g;
+                pixel[2] = colour.b;
+                pixel[3] = colour.a;
+            }
+        }
+    }
+}
+
+// write the playback as PNG frames <prefix>_<step>.png, one every stride steps plus the last step.
+// each frame has the split view layout: ground truth left, robot's map right, progress along the
+// bottom. returns the number of frames written
+int export_frames(
+    const trajectory &robot_pos,
+    std::vector<Object *> &objects,
+    std::vector<std::vector<int>> r_grid,
+    int width, int height, int radius, int l_radius, int stride,
+    const std::string &prefix) {
+
+    int num_steps = robot_pos.size();
+    stride = std::max(stride, 1);
+
+    // lookup table between occupancy (-1 to 1, offset by one) and grid cell colour
+    const sf::Color grid_cell[3] = {sf::Color(128, 128, 128),
+                                    sf::Color::White,
+                                    sf::Color::Black};
+
+    // the walls don't move: rasterize the ground truth once
+    std::vector<sf::Uint8> truthPixels(4*width*height);
+    clear_map(truthPixels, sf::Color::White);
+    sf::VertexArray scene = bake_objects(objects);
+    for (size_t v = 0; v + 2 < scene.getVertexCount(); v += 3) {
+        raster_triangle(truthPixels, width, height,
+            scene[v].position, scene[v+1].position, scene[v+2].position, scene[v].color);
+    }
+
+    // the robot's map, revealed step by step as in render_grid
+    std::vector<sf::Uint8> mapPixels(4*width*height);
+    clear_map(mapPixels, grid_cell[0]);
+    int revealed = 0;
+
+    // the frame: truth and map side by side, each panel with its own copy of the robot
+    int frame_width = 2*width;
+    std::vector<sf::Uint8> framePixels(4*frame_width*height);
+    std::vector<sf::Uint8> panel(4*width*height);
+    sf::Image image;
+    int frames = 0;
+
+    for (int step = 0; step < num_steps; step = std::min(step + stride, num_steps - 1)) {
+        int x_min = width, x_max = 0, y_min = height, y_max = 0;
+        for (; revealed < step; revealed++) {
+            reveal_disc(mapPixels, r_grid, grid_cell,
+                robot_pos[revealed].x+radius, robot_pos[revealed].y+radius, l_radius, width, height,
+                x_min, x_max, y_min, y_max);
+        }
+
+        for (int half = 0; half < 2; half++) {
+            panel = (half == 0) ? truthPixels : mapPixels;
+            raster_disc(panel, width, height,
+                robot_pos[step].x+radius, robot_pos[step].y+radius, radius, sf::Color::Green);
+            for (int y = 0; y < height; ++y) {
+                std::copy_n(&panel[4*y*width], 4*width, &framePixels[4*(y*frame_width + half*width)]);
+            }
+        }
+        // progress bar along the bottom edge, as the scrub bar of the windows
+        int filled = (int)((int64_t)frame_width*step/std::max(num_steps - 1, 1));
+        for (int y = std::max(0, height - scrub_bar_height); y < height; ++y) {
+            for (int x = 0; x < frame_width; ++x) {
+                const sf::Color colour = x < filled ? sf::Color(255, 140, 0) : sf::Color(96, 96, 96);
+                sf::Uint8 *pixel = &framePixels[4*(y*frame_width + x)];
+                pixel[0] = colour.r;
+                pixel[1] = colour.g;
+                pixel[2] = colour.b;
+                pixel[3] = colour.a;
+            }
+        }
+
+        image.create(frame_width, height, framePixels.data());
+        std::string number = std::to_string(step);
+        std::string filename = prefix + "_" + std::string(number.size() < 6 ? 6 - number.size() : 0, '0') + number + ".png";
+        if (!image.saveToFile(filename)) {
+            std::cerr << "Could not write frame " << filename << std::endl;
+            break;
+        }
+        frames++;
+        if (step == num_steps - 1) {
+            break;
+        }
+    }
+    return frames;
+}
+
+
+//==========LIVE VIEW==========
+// draw the run while it is simulated, in the split view layout. each frame drains the updates the
+// simulation published since the last one into the map texture and moves the robot to where it
+// is now; the simulation never waits for this thread. once the simulation has finished, final_grid
+// is safe to read and repaints the map if updates were dropped
+void render_live(
+    live_channel &live,
+    std::vector<Object *> &objects,
+    const std::vector<std::vector<int>> &final_grid,
+    int width, int height, int radius) {
+
+    // retrieve screen resolution to center the window
+    sf::VideoMode desktop = sf::VideoMode::getDesktopMode();
 
+    int top_left_x = (desktop.width/2) - width;
+    int top_left_y = (desktop.height/2) - (height/2);
+
+    // create the window, truth on the left and the robot's map on the right
+    sf::RenderWindow window(sf::VideoMode(2*width, height), "MTE301 Lab 4 Live Run");
+    window.setFramerateLimit(60);
+    window.setPosition(sf::Vector2i(top_left_x, top_left_y));
+
+    sf::View truthView(sf::FloatRect(0, 0, width, height));
+    truthView.setViewport(sf::FloatRect(0, 0, 0.5f, 1));
+    sf::View mapView(sf::FloatRect(0, 0, width, height));
+    mapView.setViewport(sf::FloatRect(0.5f, 0, 0.5f, 1));
+
+    // lookup table between occupancy (-1 to 1, offset by one) and grid cell colour
+    const sf::Color grid_cell[3] = {sf::Color(128, 128, 128),
+                                    sf::Color::White,
+                                    sf::Color::Black};
+
+    sf::VertexArray scene = bake_objects(objects);
+    sf::CircleShape truthRobot(radius);
+    truthRobot.setFillColor(sf::Color::Green);
+    sf::CircleShape mapRobot(radius);
+    mapRobot.setFillColor(sf::Color::Green);
+
+    // the map as the updates arrive, starting out unknown
+    std::vector<sf::Uint8> mapPixels(4*width*height);
+    clear_map(mapPixels, grid_cell[0]);
+    std::vector<sf::Uint8> rectPixels;
+    sf::Texture mapTexture;
+    mapTexture.create(width, height);
+    mapTexture.update(mapPixels.data());
+    sf::Sprite mapSprite(mapTexture);
+
+    int steps = 0;
+    bool done = false;
+
+    // main loop
+    while (window.isOpen()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                window.close();
+            }
+        }
+
+        // everything published before the simulation finished is in the ring by now
+        bool finished = live.is_finished();
+        int x_min = width, x_max = 0, y_min = height, y_max = 0;
+        live_update update;
+        while (live.poll(update)) {
+            if (update.kind == LIVE_POSITION) {
+                truthRobot.setPosition(update.x, update.y);
+                mapRobot.setPosition(update.x, update.y);
+                steps++;
+            }
+            else if (update.x >= 0 && update.x < width && update.y >= 0 && update.y < height) {
+                const sf::Color &colour = grid_cell[std::min(std::max((int)update.value, -1), 1) + 1];
+                sf::Uint8 *pixel = &mapPixels[4*(update.y*width + update.x)];
+                pixel[0] = colour.r;
+                pixel[1] = colour.g;
+                pixel[2] = colour.b;
+                pixel[3] = colour.a;
+                x_min = std::min(x_min, (int)update.x);
+                x_max = std::max(x_max, update.x + 1);
+                y_min = std::min(y_min, (int)update.y);
+                y_max = std::max(y_max, update.y + 1);
+            }
+        }
+        if (x_min < x_max && y_min < y_max) {
+            int rect_width = x_max - x_min;
+            int rect_height = y_max - y_min;
+            rectPixels.resize(4*rect_width*rect_height);
+            for (int y = y_min; y < y_max; ++y) {
+                std::copy_n(&mapPixels[4*(y*width + x_min)], 4*rect_width, &rectPixels[4*(y - y_min)*rect_width]);
+            }
+            mapTexture.update(rectPixels.data(), rect_width, rect_height, x_min, y_min);
+        }
+
+        if (finished && !done) {
+            done = true;
+            if (live.get_dropped() > 0) {
+                std::cout << "Live view: " << live.get_dropped() << " updates dropped, map repainted from the final grid" << std::endl;
+                for (int x = 0; x < width; ++x) {
+                    for (int y = 0; y < height; ++y) {
+                        const sf::Color &colour = grid_cell[std::min(std::max(final_grid[x][y], -1), 1) + 1];
+                        sf::Uint8 *pixel = &mapPixels[4*(y*width + x)];
+                        pixel[0] = colour.r;
+                        pixel[1] = colour.g;
+                        pixel[2] = colour.b;
+                        pixel[3] = colour.a;
+                    }
+                }
+                mapTexture.update(mapPixels.data());
+            }
+            window.setTitle("MTE301 Lab 4 Live Run, finished after " + std::to_string(steps) + " positions");
+        }
+
+        window.clear(sf::Color::White);
+        window.setView(truthView);
+        window.draw(scene);
+        window.draw(truthRobot);
+        window.setView(mapView);
+        window.draw(mapSprite);
+        window.draw(mapRobot);
+        window.setView(window.getDefaultView());
+        window.display();
     }
-}
\ No newline at end of file
+}
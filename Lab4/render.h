@@ -3,6 +3,8 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include "utils.h"
+#include "trajectory.h"
+#include "live.h"
 
 #ifndef RENDER
 #define RENDER
@@ -10,7 +12,7 @@
 sf::RectangleShape draw_object(int, int, int, int);
 
 void render_window(
-    std::vector<std::vector<int>> &, 
+    const trajectory &, 
     std::vector<Object *> &,
     Object, 
     int, 
@@ -19,8 +21,29 @@ void render_window(
 
 void render_grid(
     Object, 
+    const trajectory &, 
     std::vector<std::vector<int>>, 
-    std::vector<std::vector<int>>, 
-    int, int, int, int, int);
+    int, int, int, int, int,
+    const std::vector<uint8_t> &);
+
+void render_split(
+    const trajectory &,
+    std::vector<Object *> &,
+    std::vector<std::vector<int>>,
+    int, int, int, int, int,
+    const std::vector<uint8_t> &);
+
+int export_frames(
+    const trajectory &,
+    std::vector<Object *> &,
+    std::vector<std::vector<int>>,
+    int, int, int, int, int,
+    const std::string &);
+
+void render_live(
+    live_channel &,
+    std::vector<Object *> &,
+    const std::vector<std::vector<int>> &,
+    int, int, int);
 
 #endif
\ No newline at end of file
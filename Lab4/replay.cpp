@@ -0,0 +1,140 @@
+// replay a run log written by lab4 (--log <file>) without re-simulating the controller
+// usage: ./replay <run log> [step]. shows the run up to step (default: the whole run)
+// the robot's map at the step is the closest keyframe before it, brought up to date by scanning
+// from the logged positions. exact for the planners; the reactive sweep also scans between steps
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+#include "render.h"
+#include "trajectory.h"
+#include "logger.h"
+
+// robot stand-in for scanning: Object::grid_value is protected
+class replay_robot : public Object {
+    int range;
+public:
+    replay_robot(int width, int height, int lidar_range) : Object(), range(lidar_range) {
+        this->width = width;
+        this->height = height;
+    }
+    void map_environment(grid_util& true_grid, std::vector<std::vector<int>>& grid);
+};
+
+// same scan as my_robot::map_environment in lab4.cpp
+void replay_robot::map_environment(grid_util& true_grid, std::vector<std::vector<int>>& grid) {
+    int center_x = this->x + this->width/2;
+    int center_y = this->y + this->height/2;
+    int env_width = grid.size(), env_height = grid[0].size();
+    if (center_x < 0 || center_x >= env_width || center_y < 0 || center_y >= env_height) {
+        return;
+    }
+    for (int i = std::max(center_x - range, 0); i <= std::min(center_x + range, env_width-1); i++) {
+        for (int j = std::max(center_y - range, 0); j <= std::min(center_y + range, env_height-1); j++) {
+            if ((i - center_x)*(i - center_x) + (j - center_y)*(j - center_y) <= range*range) {
+                int true_value = Object::grid_value(true_grid, this, i, j, range);
+                if (true_value != -1) {
+                    grid[i][j] = true_value;
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <run log> [step]" << std::endl;
+        return 1;
+    }
+    std::string log_file = argv[1];
+    log_header header;
+    std::vector<log_record> records;
+    if (!read_run_log(log_file, header, records) || records.empty()) {
+        return 1;
+    }
+    // the loop stops one step after the last logged position; lab4 keyframes the final map there
+    uint32_t step = records.back().step + 1;
+    if (argc > 2) {
+        int last = 0;
+        if (!parse_int(argv[2], 0, last)) {
+            std::cerr << "usage: " << argv[0] << " <run log> [step]" << std::endl;
+            return 1;
+        }
+        step = std::min<uint32_t>(last, step);
+    }
+
+    //==========WALLS FROM THE CONFIG, AS IN LAB4==========
+    std::tuple<std::string, bool, int, int> config = read_csv();
+    std::string filename = std::get<0>(config);
+    if (filename.find("environment" + std::to_string(header.env_type) + ".csv") == std::string::npos) {
+        std::cerr << "Warning: the run was logged in environment " << header.env_type
+            << ", config.csv has " << filename << std::endl;
+    }
+    grid_util grid(header.env_width, header.env_height, 50, 100);
+    std::vector<Object*> walls;
+    if (std::get<3>(config) == 4) {
+        walls = grid.create_walls(filename);
+    }
+    else {
+        walls = grid.create_angled_walls(filename);
+    }
+
+    //==========TRAJECTORY AND MAP AT THE STEP==========
+    int diameter = 2*header.radius;
+    trajectory robot_pos;
+    for (const log_record& record: records) {
+        if (record.step > step) {
+            break;
+        }
+        robot_pos.push_back(record.x, record.y);
+    }
+
+    // the map at the end of step includes the scans from every position logged before it
+    std::vector<std::vector<int>> robot_grid;
+    int key_step = read_keyframe(log_file, header, step, robot_grid);
+    replay_robot scanner(diameter, diameter, header.lidar_range);
+    for (const log_record& record: records) {
+        if (record.step >= step) {
+            break;
+        }
+        if ((int)record.step >= key_step) {
+            scanner.x = record.x;
+            scanner.y = record.y;
+            scanner.map_environment(grid, robot_grid);
+        }
+    }
+    if (key_step < 0) {
+        std::cout << "No keyframes, map rebuilt from all " << robot_pos.size() << " positions" << std::endl;
+    }
+    else {
+        std::cout << "Step " << step << ": keyframe at step " << key_step << std::endl;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Percent of walls correctly mapped: " << grid.wall_accuracy(robot_grid)*100.0 << "%" << std::endl;
+    std::cout << "Percent of environment correctly mapped: " << grid.grid_accuracy(robot_grid)*100.0 << "%" << std::endl;
+    std::vector<uint8_t> diff = grid.diff_map(robot_grid);
+    grid.print_diff_summary(diff, 100);
+
+    // render the run from its first position
+    Object robot_init;
+    robot_init.width = diameter;
+    robot_init.height = diameter;
+    robot_init.x = records[0].x;
+    robot_init.y = records[0].y;
+    if (std::get<1>(config)) {
+        render_split(robot_pos, walls, robot_grid, header.env_width, header.env_height, header.radius,
+            header.lidar_range, std::get<2>(config), diff);
+    }
+    else {
+        render_grid(robot_init, robot_pos, robot_grid, header.env_width, header.env_height, header.radius,
+            header.lidar_range, std::get<2>(config), diff);
+    }
+
+    return 0;
+}
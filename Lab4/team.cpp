@@ -0,0 +1,103 @@
+// team mode: parallel steps and the team map
+
+#include <algorithm>
+
+#include "team.h"
+
+// constructor
+step_pool::step_pool(int threads) {
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(&step_pool::worker_loop, this);
+    }
+}
+
+step_pool::~step_pool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    start.notify_all();
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+}
+
+// take job indices until the batch runs out
+void step_pool::work(const std::function<void(int)>& fn, int n) {
+    int count = 0;
+    for (int i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+        fn(i);
+        count++;
+    }
+    if (count > 0) {
+        std::lock_guard<std::mutex> guard(lock);
+        finished += count;
+        if (finished == n) {
+            done.notify_all();
+        }
+    }
+}
+
+void step_pool::worker_loop() {
+    unsigned long seen = 0;
+    while (true) {
+        const std::function<void(int)> *fn;
+        int n;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            start.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            fn = job;
+            n = num_jobs;
+            busy++;
+        }
+        work(*fn, n);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            busy--;
+        }
+        done.notify_all();
+    }
+}
+
+// fn(i) for every i in [0, n) across the workers and the caller, returns once all are done.
+// the next batch waits for late workers to leave this one, so they never see its job counter
+void step_pool::run(int n, const std::function<void(int)>& fn) {
+    if (n <= 0) {
+        return;
+    }
+    if (workers.empty()) {
+        for (int i = 0; i < n; i++) {
+            fn(i);
+        }
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [&] { return busy == 0; });
+        job = &fn;
+        num_jobs = n;
+        next.store(0);
+        finished = 0;
+        generation++;
+    }
+    start.notify_all();
+    work(fn, n);
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [&] { return finished == n; });
+}
+
+int step_pool::get_num_threads() const {
+    return this->workers.size() + 1;
+}
+
+bool footprints_overlap(int x1, int y1, int x2, int y2, int r) {
+    int dx = x1 - x2, dy = y1 - y2;
+    return dx*dx + dy*dy < 4*r*r;
+}
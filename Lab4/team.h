@@ -0,0 +1,44 @@
+// team mode: several robots explore at once, each with its own map, against one ground truth.
+// step_pool runs one step of every robot across persistent worker threads; the caller checks the
+// robots against each other between steps. the team map is in map_merge.h
+#ifndef TEAM
+#define TEAM
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class step_pool {
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable start;      // a new batch, or stopping
+    std::condition_variable done;       // a batch finished, or a worker went idle
+    const std::function<void(int)> *job{nullptr};
+    int num_jobs{0};
+    std::atomic<int> next{0};           // next job index to hand out
+    int finished{0};                    // jobs done in this batch
+    int busy{0};                        // workers inside a batch
+    unsigned long generation{0};        // batches started
+    bool stopping{false};
+    private:
+        void work(const std::function<void(int)>&, int);
+        void worker_loop();
+    public:
+        // constructor. threads counts the caller, which works too. 0 for one per core
+        step_pool(int threads = 0);
+        ~step_pool();
+        step_pool(const step_pool&) = delete;
+        step_pool& operator=(const step_pool&) = delete;
+        // functions
+        void run(int, const std::function<void(int)>&);
+        // getters
+        int get_num_threads() const;
+};
+
+// robots are discs of radius r with top left corners (x1, y1) and (x2, y2)
+bool footprints_overlap(int, int, int, int, int);
+
+#endif
@@ -0,0 +1,79 @@
+// trajectory recorder
+
+#include <algorithm>
+#include <vector>
+
+#include "trajectory.h"
+
+// constructor. capacity > 0 turns on ring mode, decimation n keeps every n-th point
+trajectory::trajectory(size_t capacity, int decimation):
+    capacity(capacity),
+    decimation(std::max(decimation, 1))
+{
+}
+
+// physical slot i, counted from the first slot of the first chunk
+traj_point& trajectory::slot(size_t i) {
+    return chunks[i / chunk_size][i % chunk_size];
+}
+
+const traj_point& trajectory::slot(size_t i) const {
+    return chunks[i / chunk_size][i % chunk_size];
+}
+
+void trajectory::push_back(int x, int y) {
+    last = {static_cast<int16_t>(x), static_cast<int16_t>(y)};
+    // always keep the first point, then every decimation-th one
+    if (num_recorded++ % decimation != 0) {
+        pending = true;
+        return;
+    }
+    pending = false;
+    // ring mode and full: overwrite the oldest point
+    if (capacity > 0 && num_stored == capacity) {
+        slot(start) = last;
+        start = (start + 1) % capacity;
+        return;
+    }
+    if (num_stored / chunk_size == chunks.size()) {
+        chunks.emplace_back();
+        chunks.back().reserve(chunk_size);
+    }
+    chunks[num_stored / chunk_size].push_back(last);
+    num_stored++;
+}
+
+// drop all points but keep the chunks for reuse
+void trajectory::clear() {
+    for (auto &chunk: chunks) {
+        chunk.clear();
+    }
+    num_stored = 0;
+    start = 0;
+    num_recorded = 0;
+    pending = false;
+}
+
+// i-th point from the oldest one kept. the latest point comes last even when decimation skipped it
+traj_point trajectory::operator[](size_t i) const {
+    if (pending && i == num_stored) {
+        return last;
+    }
+    return slot(capacity > 0 ? (start + i) % capacity : i);
+}
+
+traj_point trajectory::back() const {
+    return last;
+}
+
+size_t trajectory::size() const {
+    return num_stored + (pending ? 1 : 0);
+}
+
+bool trajectory::empty() const {
+    return num_recorded == 0;
+}
+
+size_t trajectory::get_num_recorded() const {
+    return this->num_recorded;
+}
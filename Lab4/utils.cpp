@@ -3,12 +3,17 @@
 
 #include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <random>
 #include <string>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "utils.h"
 
@@ -28,6 +33,23 @@ std::string trim(const std::string& str) {
     return strBegin == std::string::npos ? "" : str.substr(strBegin, strRange);
 }
 
+// a command line number: true and value set if all of str is an int of at least min_value
+bool parse_int(const std::string& str, int min_value, int& value) {
+    size_t pos = 0;
+    int parsed = 0;
+    try {
+        parsed = std::stoi(str, &pos);
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    if (pos != str.size() || parsed < min_value) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
 std::tuple<std::string, bool, int, int> read_csv() {
     // tuple to store the return values: (csv_file, render_ground_truth, render_speed)
     std::tuple<std::string, bool, int, int> config_values;
@@ -207,6 +229,134 @@ grid_util::grid_util(int width, int height, int min_size, int max_size) :
     }
 }
 
+// build the inflated layer from the ground truth. call again if walls/objects are added afterwards
+void grid_util::build_inflation(int radius, int margin) {
+    this->inflated = inflation_layer(env_width, env_height, radius, margin);
+    this->inflated.build(this->grid);
+}
+
+// point check for the robot center (x, y) against the inflated layer
+bool grid_util::is_free_inflated(int x, int y) {
+    return this->inflated.is_free(x, y);
+}
+
+// true if any wall cell lies under the robot's box. is_collision() only checks the corners
+bool grid_util::hits_wall(Object& robot) {
+    for (int i = std::max(robot.x, 0); i <= std::min(robot.x+robot.width, env_width-1); i++) {
+        for (int j = std::max(robot.y, 0); j <= std::min(robot.y+robot.height, env_height-1); j++) {
+            if (this->grid[i][j] >= 1) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// classify every cell of grid_pred against the truth (diff_class), flat in x*env_height + y order.
+// along each column only the span between the first and last true wall is scored, the rest is
+// outside the environment. the span is compared 16 cells at a time with SSE2 where available
+std::vector<uint8_t> grid_util::diff_map(const std::vector<std::vector<int>>& grid_pred) {
+    std::vector<uint8_t> diff(env_width*env_height, DIFF_OUTSIDE);
+    for (int i = 0; i < env_width; i++) {
+        const int *truth = this->grid[i].data();
+        const int *pred = grid_pred[i].data();
+        uint8_t *out = &diff[i*env_height];
+        int first = 0, last = env_height - 1;
+        while (first < env_height && truth[first] < 1) {
+            first++;
+        }
+        while (last >= first && truth[last] < 1) {
+            last--;
+        }
+        int j = first;
+#ifdef __SSE2__
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i two = _mm_set1_epi32(2);
+        const __m128i three = _mm_set1_epi32(3);
+        for (; j + 16 <= last + 1; j += 16) {
+            __m128i cls[4];
+            for (int k = 0; k < 4; k++) {
+                __m128i p = _mm_loadu_si128((const __m128i*)(pred + j + 4*k));
+                __m128i t = _mm_loadu_si128((const __m128i*)(truth + j + 4*k));
+                __m128i unknown = _mm_cmplt_epi32(p, zero);
+                __m128i wall_p = _mm_cmpgt_epi32(p, zero);
+                __m128i wall_t = _mm_cmpgt_epi32(t, zero);
+                // false wall 1, missed wall 2, correct 0; unknown 3 overrides
+                __m128i c = _mm_or_si128(_mm_and_si128(_mm_andnot_si128(wall_t, wall_p), one),
+                                         _mm_and_si128(_mm_andnot_si128(wall_p, wall_t), two));
+                cls[k] = _mm_or_si128(_mm_and_si128(unknown, three), _mm_andnot_si128(unknown, c));
+            }
+            // 16 int32 down to 16 bytes
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(cls[0], cls[1]), _mm_packs_epi32(cls[2], cls[3]));
+            _mm_storeu_si128((__m128i*)(out + j), packed);
+        }
+#endif
+        for (; j <= last; j++) {
+            if (pred[j] < 0) {
+                out[j] = DIFF_UNKNOWN;
+            }
+            else if ((pred[j] >= 1) == (truth[j] >= 1)) {
+                out[j] = DIFF_CORRECT;
+            }
+            else {
+                out[j] = (pred[j] >= 1) ? DIFF_FALSE_WALL : DIFF_MISSED_WALL;
+            }
+        }
+    }
+    return diff;
+}
+
+// counts of a diff_map per region_size x region_size square, row by row (index: y/region_size *
+// regions across + x/region_size)
+std::vector<diff_counts> grid_util::diff_regions(const std::vector<uint8_t>& diff, int region_size) {
+    int across = (env_width + region_size - 1) / region_size;
+    int down = (env_height + region_size - 1) / region_size;
+    std::vector<diff_counts> regions(across*down);
+    for (int i = 0; i < env_width; i++) {
+        for (int j = 0; j < env_height; j++) {
+            diff_counts &counts = regions[(j/region_size)*across + i/region_size];
+            switch (diff[i*env_height + j]) {
+                case DIFF_CORRECT: counts.correct++; break;
+                case DIFF_FALSE_WALL: counts.false_wall++; break;
+                case DIFF_MISSED_WALL: counts.missed_wall++; break;
+                case DIFF_UNKNOWN: counts.unknown++; break;
+                default: break;
+            }
+        }
+    }
+    return regions;
+}
+
+// print the diff totals and the regions with the most wrong or unknown cells
+void grid_util::print_diff_summary(const std::vector<uint8_t>& diff, int region_size) {
+    std::vector<diff_counts> regions = diff_regions(diff, region_size);
+    int across = (env_width + region_size - 1) / region_size;
+    diff_counts total;
+    std::vector<std::pair<int, int>> errors;        // (wrong or unknown cells, region)
+    for (size_t r = 0; r < regions.size(); r++) {
+        total.correct += regions[r].correct;
+        total.false_wall += regions[r].false_wall;
+        total.missed_wall += regions[r].missed_wall;
+        total.unknown += regions[r].unknown;
+        int wrong = regions[r].false_wall + regions[r].missed_wall + regions[r].unknown;
+        if (wrong > 0) {
+            errors.push_back({wrong, (int)r});
+        }
+    }
+    std::cout << "Map diff: " << total.correct << " correct, " << total.false_wall << " false walls, "
+        << total.missed_wall << " missed walls, " << total.unknown << " unknown" << std::endl;
+    std::sort(errors.begin(), errors.end(), std::greater<std::pair<int, int>>());
+    for (int k = 0; k < std::min<int>(errors.size(), 5); k++) {
+        const diff_counts &counts = regions[errors[k].second];
+        int x = (errors[k].second % across) * region_size;
+        int y = (errors[k].second / across) * region_size;
+        std::cout << "  region x " << x << "-" << x + region_size - 1 << ", y " << y << "-" << y + region_size - 1
+            << ": " << counts.false_wall << " false walls, " << counts.missed_wall << " missed walls, "
+            << counts.unknown << " unknown" << std::endl;
+    }
+}
+
 // create a single object. for robot and goal.
 Object grid_util::create_object(
     grid_util & grid, 
@@ -910,4 +1060,128 @@ float grid_util::wall_accuracy(std::vector<std::vector<int>> grid_pred) {
     // std::cout << "count: " << count << std::endl;
     // std::cout << "correct_count: " << correct_count << std::endl;
     return correct_count/count;
+}
+
+// inflation layer
+// default constructor
+inflation_layer::inflation_layer() {}
+// robot footprint spans center +/- radius, so dilating by radius+margin makes point checks exact
+inflation_layer::inflation_layer(int width, int height, int radius, int margin):
+    env_width(width),
+    env_height(height),
+    inflate(radius + margin)
+{
+    occupied = std::vector<unsigned char>(env_width*env_height, 0);
+    row_pass = std::vector<unsigned char>(env_width*env_height, 0);
+    inflated = std::vector<unsigned char>(env_width*env_height, 0);
+}
+
+// full rebuild from a grid. Walls/obstacles are any value >= 1, unknown (-1) is treated as free
+void inflation_layer::build(const std::vector<std::vector<int>>& src) {
+    for (int i = 0; i < env_width; i++) {
+        for (int j = 0; j < env_height; j++) {
+            occupied[i*env_height + j] = (src[i][j] >= 1);
+        }
+    }
+    dilate_rows(0, 0, env_width-1, env_height-1);
+    dilate_cols(0, 0, env_width-1, env_height-1);
+}
+
+// incremental update after cells in [x_min, x_max] x [y_min, y_max] (inclusive) were written.
+// only the cells within inflate of the changed box are recomputed
+void inflation_layer::update(const std::vector<std::vector<int>>& src, int x_min, int y_min, int x_max, int y_max) {
+    x_min = std::max(x_min, 0);
+    y_min = std::max(y_min, 0);
+    x_max = std::min(x_max, env_width-1);
+    y_max = std::min(y_max, env_height-1);
+    if (x_min > x_max || y_min > y_max) {
+        return;
+    }
+    for (int i = x_min; i <= x_max; i++) {
+        for (int j = y_min; j <= y_max; j++) {
+            occupied[i*env_height + j] = (src[i][j] >= 1);
+        }
+    }
+    // horizontal pass only changes in the rows that were written, vertical pass spreads it by inflate
+    dilate_rows(x_min - inflate, y_min, x_max + inflate, y_max);
+    dilate_cols(x_min - inflate, y_min - inflate, x_max + inflate, y_max + inflate);
+}
+
+// separable dilation, pass 1: sliding window count of occupied cells along x for each row
+void inflation_layer::dilate_rows(int x_min, int y_min, int x_max, int y_max) {
+    x_min = std::max(x_min, 0);
+    x_max = std::min(x_max, env_width-1);
+    for (int j = y_min; j <= y_max; j++) {
+        // count for the window centered at x_min
+        int count = 0;
+        for (int i = std::max(x_min - inflate, 0); i <= std::min(x_min + inflate, env_width-1); i++) {
+            count += occupied[i*env_height + j];
+        }
+        for (int i = x_min; i <= x_max; i++) {
+            row_pass[i*env_height + j] = (count > 0);
+            // slide the window one cell to the right
+            if (i - inflate >= 0) {
+                count -= occupied[(i-inflate)*env_height + j];
+            }
+            if (i + inflate + 1 < env_width) {
+                count += occupied[(i+inflate+1)*env_height + j];
+            }
+        }
+    }
+}
+
+// separable dilation, pass 2: sliding window count of row_pass cells along y for each column
+void inflation_layer::dilate_cols(int x_min, int y_min, int x_max, int y_max) {
+    x_min = std::max(x_min, 0);
+    y_min = std::max(y_min, 0);
+    x_max = std::min(x_max, env_width-1);
+    y_max = std::min(y_max, env_height-1);
+    for (int i = x_min; i <= x_max; i++) {
+        const unsigned char* col = &row_pass[i*env_height];
+        int count = 0;
+        for (int j = std::max(y_min - inflate, 0); j <= std::min(y_min + inflate, env_height-1); j++) {
+            count += col[j];
+        }
+        for (int j = y_min; j <= y_max; j++) {
+            inflated[i*env_height + j] = (count > 0);
+            if (j - inflate >= 0) {
+                count -= col[j-inflate];
+            }
+            if (j + inflate + 1 < env_height) {
+                count += col[j+inflate+1];
+            }
+        }
+    }
+}
+
+// mark the centers within r of (x, y) as not free, e.g. where another robot stands. lasts until
+// update() is called on those cells
+void inflation_layer::block_disc(int x, int y, int r) {
+    for (int i = std::max(x - r, 0); i <= std::min(x + r, env_width-1); i++) {
+        for (int j = std::max(y - r, 0); j <= std::min(y + r, env_height-1); j++) {
+            if ((i - x)*(i - x) + (j - y)*(j - y) < r*r) {
+                inflated[i*env_height + j] = 1;
+            }
+        }
+    }
+}
+
+// true if the robot centered at (x, y) does not touch any wall/obstacle. out of bounds is never free
+bool inflation_layer::is_free(int x, int y) const {
+    if (x < 0 || x >= env_width || y < 0 || y >= env_height) {
+        return false;
+    }
+    return !inflated[x*env_height + y];
+}
+
+// true if (x, y) itself is a wall/obstacle in the source grid
+bool inflation_layer::is_occupied(int x, int y) const {
+    if (x < 0 || x >= env_width || y < 0 || y >= env_height) {
+        return true;
+    }
+    return occupied[x*env_height + y];
+}
+
+int inflation_layer::get_inflation() const {
+    return this->inflate;
 }
\ No newline at end of file
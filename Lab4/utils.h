@@ -3,6 +3,7 @@
 #ifndef UTIL
 #define UTIL
 
+#include <cstdint>
 #include <random>
 #include <iostream>
 #include <map>
@@ -11,6 +12,7 @@
 
 // functions
 std::string trim(const std::string& );
+bool parse_int(const std::string&, int, int&);
 // std::pair<std::string, bool> read_csv();
 std::tuple<std::string, bool, int, int> read_csv();
 
@@ -50,6 +52,43 @@ class random_generator {
         int create_random(int, int);
 };
 
+// obstacle layer dilated by half the robot footprint plus a safety margin. A point check at the
+// robot center on this layer is the same as checking the whole (2*radius)x(2*radius) footprint
+class inflation_layer {
+    std::vector<unsigned char> occupied;    // 1 where the source grid has a wall/obstacle
+    std::vector<unsigned char> row_pass;    // 1 if any occupied cell within +/-inflate along x
+    std::vector<unsigned char> inflated;    // 1 if any row_pass cell within +/-inflate along y
+    int env_width{0}, env_height{0}, inflate{0};
+    private:
+        void dilate_rows(int, int, int, int);
+        void dilate_cols(int, int, int, int);
+    public:
+        // constructor
+        inflation_layer();
+        inflation_layer(int, int, int, int);
+        // functions
+        void build(const std::vector<std::vector<int>>&);
+        void update(const std::vector<std::vector<int>>&, int, int, int, int);
+        void block_disc(int, int, int);
+        bool is_free(int, int) const;
+        bool is_occupied(int, int) const;
+        // getters
+        int get_inflation() const;
+};
+
+// per cell comparison of a robot's map with the truth, see grid_util::diff_map
+enum diff_class : uint8_t {
+    DIFF_CORRECT,                       // free or wall, as in the truth
+    DIFF_FALSE_WALL,                    // mapped as a wall, free in the truth
+    DIFF_MISSED_WALL,                   // mapped as free, a wall in the truth
+    DIFF_UNKNOWN,                       // never seen, inside the walls
+    DIFF_OUTSIDE                        // outside the environment's walls, not scored
+};
+
+struct diff_counts {
+    int correct{0}, false_wall{0}, missed_wall{0}, unknown{0};
+};
+
 class grid_util {
     //Occupancy grid; outer vector represents rows, inner represents columns along each row, initialized to 0's
     std::vector<std::vector<int>> grid;
@@ -61,6 +100,7 @@ class grid_util {
     private:
         int grid_value(int&&, int&&, int&, int&, int&);
         int max_y{0}, min_y{800};
+        inflation_layer inflated;   //walls dilated by the robot footprint, see build_inflation()
     public:
         // constructor
         grid_util(int, int, int, int);
@@ -78,6 +118,12 @@ class grid_util {
         std::vector<std::vector<float>> read_csv(std::string, int);
         float wall_accuracy(std::vector<std::vector<int>>);
         float grid_accuracy(std::vector<std::vector<int>>);
+        void build_inflation(int, int);
+        bool is_free_inflated(int, int);
+        bool hits_wall(Object&);
+        std::vector<uint8_t> diff_map(const std::vector<std::vector<int>>&);
+        std::vector<diff_counts> diff_regions(const std::vector<uint8_t>&, int);
+        void print_diff_summary(const std::vector<uint8_t>&, int);
         // getters
         int get_min_y();
         int get_max_y();
@@ -0,0 +1,175 @@
+// wall sensing for the wall follower
+
+#include <algorithm>
+
+#include "wall_probe.h"
+
+// constructor
+wall_probe::wall_probe(int tol): probes(make_probe_offsets(tol)) {}
+
+// wall mask around the robot's center (c_x, c_y) in its map: bit d set if a probe of direction d
+// is on a wall (1). at most one bit per axis: the negative side isn't probed once the positive
+// side has hit. the bounds checks are only needed within reach of the map's edges
+uint8_t wall_probe::sense(const std::vector<std::vector<int>>& grid, int c_x, int c_y) const {
+    int env_width = grid.size(), env_height = grid[0].size();
+    bool inside = c_x - probes.reach >= 0 && c_x + probes.reach < env_width
+        && c_y - probes.reach >= 0 && c_y + probes.reach < env_height;
+    uint8_t mask = 0;
+    for (int d = 0; d < NUM_WALL_DIRS; d++) {
+        if ((d & 1) && (mask & (1 << (d - 1)))) {
+            continue;
+        }
+        for (int k = 0; k < probes.count[d]; k++) {
+            int px = c_x + probes.dx[d][k];
+            int py = c_y + probes.dy[d][k];
+            if (!inside && (px < 0 || px >= env_width || py < 0 || py >= env_height)) {
+                continue;
+            }
+            if (grid[px][py] == 1) {
+                mask |= 1 << d;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+// steps the robot can take along (dx, dy) from center (c_x, c_y) while the mask sensed there
+// (mask) is sure to stay the same, at most limit. the map must not change meanwhile.
+// single axis moves only, 0 for diagonals or when the probes could leave the map
+int wall_probe::steady_steps(const std::vector<std::vector<int>>& grid, const wall_runs& runs, int c_x, int c_y,
+    uint8_t mask, int dx, int dy, int limit) const {
+    if ((dx != 0) == (dy != 0)) {
+        return 0;
+    }
+    int env_width = runs.get_width(), env_height = runs.get_height();
+    if (c_x - probes.reach < 0 || c_x + probes.reach >= env_width
+        || c_y - probes.reach < 0 || c_y + probes.reach >= env_height) {
+        return 0;
+    }
+    int dir, room;
+    if (dx > 0) {
+        dir = WALL_RIGHT;
+        room = env_width - 1 - (c_x + probes.reach);
+    }
+    else if (dx < 0) {
+        dir = WALL_LEFT;
+        room = c_x - probes.reach;
+    }
+    else if (dy > 0) {
+        dir = WALL_BOTTOM;
+        room = env_height - 1 - (c_y + probes.reach);
+    }
+    else {
+        dir = WALL_TOP;
+        room = c_y - probes.reach;
+    }
+    int steps = std::min(limit, room);
+    // an axis keeps its state while its positive side keeps hitting, or while neither side changes
+    for (int axis = 0; axis < 4 && steps > 0; axis++) {
+        int pos = 2*axis, neg = 2*axis + 1;
+        if (mask & (1 << pos)) {
+            steps = std::min(steps, hit_steps(grid, runs, c_x, c_y, pos, dir));
+            continue;
+        }
+        steps = std::min(steps, free_steps(runs, c_x, c_y, pos, dir));
+        if (mask & (1 << neg)) {
+            steps = std::min(steps, hit_steps(grid, runs, c_x, c_y, neg, dir));
+        }
+        else {
+            steps = std::min(steps, free_steps(runs, c_x, c_y, neg, dir));
+        }
+    }
+    return steps;
+}
+
+// steps along dir before a hit direction d could stop hitting: as long as one of its probes
+// stays on a wall
+int wall_probe::hit_steps(const std::vector<std::vector<int>>& grid, const wall_runs& runs, int c_x, int c_y,
+    int d, int dir) const {
+    int steps = 0;
+    for (int k = 0; k < probes.count[d]; k++) {
+        int px = c_x + probes.dx[d][k];
+        int py = c_y + probes.dy[d][k];
+        if (grid[px][py] == 1) {
+            steps = std::max(steps, runs.run(dir, px, py) - 1);
+        }
+    }
+    return steps;
+}
+
+// steps along dir before a direction d without a hit could start hitting
+int wall_probe::free_steps(const wall_runs& runs, int c_x, int c_y, int d, int dir) const {
+    int steps = runs.run(dir, c_x + probes.dx[d][0], c_y + probes.dy[d][0]) - 1;
+    for (int k = 1; k < probes.count[d]; k++) {
+        steps = std::min(steps, runs.run(dir, c_x + probes.dx[d][k], c_y + probes.dy[d][k]) - 1);
+    }
+    return steps;
+}
+
+// run lengths
+
+wall_runs::wall_runs() {}
+
+// constructor, for a map without walls: every run reaches the edge
+wall_runs::wall_runs(int env_width, int env_height): env_width(env_width), env_height(env_height) {
+    for (int dir = 0; dir < 4; dir++) {
+        runs[dir].resize((size_t)env_width*env_height);
+    }
+    for (int x = 0; x < env_width; x++) {
+        for (int y = 0; y < env_height; y++) {
+            size_t i = (size_t)x*env_height + y;
+            runs[WALL_RIGHT][i] = env_width - x;
+            runs[WALL_LEFT][i] = x + 1;
+            runs[WALL_BOTTOM][i] = env_height - y;
+            runs[WALL_TOP][i] = y + 1;
+        }
+    }
+}
+
+// recompute the x runs of row y
+void wall_runs::scan_row(const std::vector<std::vector<int>>& grid, int y) {
+    runs[WALL_RIGHT][(size_t)(env_width - 1)*env_height + y] = 1;
+    for (int x = env_width - 2; x >= 0; x--) {
+        size_t i = (size_t)x*env_height + y;
+        runs[WALL_RIGHT][i] = ((grid[x][y] == 1) == (grid[x + 1][y] == 1)) ? runs[WALL_RIGHT][i + env_height] + 1 : 1;
+    }
+    runs[WALL_LEFT][y] = 1;
+    for (int x = 1; x < env_width; x++) {
+        size_t i = (size_t)x*env_height + y;
+        runs[WALL_LEFT][i] = ((grid[x][y] == 1) == (grid[x - 1][y] == 1)) ? runs[WALL_LEFT][i - env_height] + 1 : 1;
+    }
+}
+
+// recompute the y runs of column x
+void wall_runs::scan_col(const std::vector<std::vector<int>>& grid, int x) {
+    const std::vector<int>& col = grid[x];
+    uint16_t *down = &runs[WALL_BOTTOM][(size_t)x*env_height];
+    uint16_t *up = &runs[WALL_TOP][(size_t)x*env_height];
+    down[env_height - 1] = 1;
+    for (int y = env_height - 2; y >= 0; y--) {
+        down[y] = ((col[y] == 1) == (col[y + 1] == 1)) ? down[y + 1] + 1 : 1;
+    }
+    up[0] = 1;
+    for (int y = 1; y < env_height; y++) {
+        up[y] = ((col[y] == 1) == (col[y - 1] == 1)) ? up[y - 1] + 1 : 1;
+    }
+}
+
+// cells in [x_min, x_max] x [y_min, y_max] changed wall state: their rows and columns are rescanned
+void wall_runs::update(const std::vector<std::vector<int>>& grid, int x_min, int y_min, int x_max, int y_max) {
+    for (int y = y_min; y <= y_max; y++) {
+        scan_row(grid, y);
+    }
+    for (int x = x_min; x <= x_max; x++) {
+        scan_col(grid, x);
+    }
+}
+
+int wall_runs::get_width() const {
+    return this->env_width;
+}
+
+int wall_runs::get_height() const {
+    return this->env_height;
+}
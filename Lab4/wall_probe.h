@@ -0,0 +1,140 @@
+// wall sensing for the wall follower. the robot's map is probed in eight directions around its
+// center, the hits are packed into a bitmask and a table built at compile time maps every mask
+// to its wall vector, so a step is a few grid reads and one lookup
+#ifndef WALL_PROBE
+#define WALL_PROBE
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// probe directions, bit d of a wall mask. axis d/2 is x, y, v (diagonal down right) or w
+// (diagonal up right); the even bit is the positive side and wins when both sides see a wall
+enum wall_dir : uint8_t {
+    WALL_RIGHT,
+    WALL_LEFT,
+    WALL_BOTTOM,
+    WALL_TOP,
+    WALL_BOTTOM_RIGHT,
+    WALL_TOP_LEFT,
+    WALL_TOP_RIGHT,
+    WALL_BOTTOM_LEFT,
+    NUM_WALL_DIRS
+};
+
+struct wall_entry {
+    int8_t xw, yw;                      // wall vector, each -1, 0 or 1
+    uint8_t hits;                       // axes with a wall
+    uint8_t axes;                       // bit i set if axis i has a wall (the run log's mode)
+};
+
+struct wall_table {
+    wall_entry entry[256];
+};
+
+// Table 2 of the lab manual: the axes with a wall are summed into (xw, yw), then normalised
+constexpr wall_table make_wall_table() {
+    wall_table table{};
+    for (int mask = 0; mask < 256; mask++) {
+        int xw = 0, yw = 0, hits = 0, axes = 0;
+        for (int axis = 0; axis < 4; axis++) {
+            int side = 0;
+            if (mask & (1 << 2*axis)) {
+                side = 1;
+            }
+            else if (mask & (1 << (2*axis + 1))) {
+                side = -1;
+            }
+            if (side == 0) {
+                continue;
+            }
+            hits++;
+            axes |= 1 << axis;
+            if (axis == 0) { xw += side; }                      // x
+            else if (axis == 1) { yw += side; }                 // y
+            else if (axis == 2) { xw += side; yw += side; }     // v
+            else { xw += side; yw -= side; }                    // w
+        }
+        table.entry[mask].xw = (xw > 0) - (xw < 0);
+        table.entry[mask].yw = (yw > 0) - (yw < 0);
+        table.entry[mask].hits = hits;
+        table.entry[mask].axes = axes;
+    }
+    return table;
+}
+
+// probe points of each direction, relative to the robot's center. x and the diagonals probe
+// three points 3 px apart, y a single point. constexpr: a constant tol gives them at compile time
+struct probe_offsets {
+    int dx[NUM_WALL_DIRS][3];
+    int dy[NUM_WALL_DIRS][3];
+    int count[NUM_WALL_DIRS];
+    int reach;                          // largest |dx| or |dy|
+};
+
+constexpr probe_offsets make_probe_offsets(int tol) {
+    probe_offsets probes{};
+    int tol_45 = static_cast<int>(tol * 0.70710678118);
+    // x: along y at +-tol in x
+    for (int k = 0; k < 3; k++) {
+        int offset = 3*k - 3;
+        probes.dx[WALL_RIGHT][k] = tol;                 probes.dy[WALL_RIGHT][k] = offset;
+        probes.dx[WALL_LEFT][k] = -tol;                 probes.dy[WALL_LEFT][k] = offset;
+        // diagonals: shifted along v on both
+        probes.dx[WALL_BOTTOM_RIGHT][k] = tol_45 + offset;   probes.dy[WALL_BOTTOM_RIGHT][k] = tol_45 + offset;
+        probes.dx[WALL_TOP_LEFT][k] = -tol_45 + offset;      probes.dy[WALL_TOP_LEFT][k] = -tol_45 + offset;
+        probes.dx[WALL_TOP_RIGHT][k] = tol_45 + offset;      probes.dy[WALL_TOP_RIGHT][k] = -tol_45 + offset;
+        probes.dx[WALL_BOTTOM_LEFT][k] = -tol_45 + offset;   probes.dy[WALL_BOTTOM_LEFT][k] = tol_45 + offset;
+    }
+    probes.dx[WALL_BOTTOM][0] = 0;                      probes.dy[WALL_BOTTOM][0] = tol;
+    probes.dx[WALL_TOP][0] = 0;                         probes.dy[WALL_TOP][0] = -tol;
+    for (int d = 0; d < NUM_WALL_DIRS; d++) {
+        probes.count[d] = (d == WALL_BOTTOM || d == WALL_TOP) ? 1 : 3;
+    }
+    probes.reach = (tol > tol_45 + 3) ? tol : tol_45 + 3;
+    if (probes.reach < 3) {
+        probes.reach = 3;
+    }
+    return probes;
+}
+
+// run lengths of the robot's map along +x, -x, +y and -y (indexed like WALL_RIGHT..WALL_TOP): the
+// number of cells from a cell on whose wall state (1 or not) is the same as its own, counting
+// itself. lets the wall follower predict how long the wall mask stays the same along a line
+class wall_runs {
+    std::vector<uint16_t> runs[4];      // x*env_height + y, one per direction
+    int env_width{0}, env_height{0};
+    private:
+        void scan_row(const std::vector<std::vector<int>>&, int);
+        void scan_col(const std::vector<std::vector<int>>&, int);
+    public:
+        // constructor, for a map without walls
+        wall_runs();
+        wall_runs(int, int);
+        // functions
+        void update(const std::vector<std::vector<int>>&, int, int, int, int);
+        int run(int dir, int x, int y) const { return runs[dir][x*env_height + y]; }
+        // getters
+        int get_width() const;
+        int get_height() const;
+};
+
+class wall_probe {
+    probe_offsets probes;
+    private:
+        int hit_steps(const std::vector<std::vector<int>>&, const wall_runs&, int, int, int, int) const;
+        int free_steps(const wall_runs&, int, int, int, int) const;
+    public:
+        static constexpr wall_table table = make_wall_table();
+        // constructor. tol: distance from the robot's center at which a wall is sensed
+        wall_probe(int tol = 0);
+        // functions
+        uint8_t sense(const std::vector<std::vector<int>>&, int, int) const;
+        int steady_steps(const std::vector<std::vector<int>>&, const wall_runs&, int, int, uint8_t, int, int,
+            int) const;
+        static const wall_entry& lookup(uint8_t mask) { return table.entry[mask]; }
+        // getters
+        int get_reach() const { return this->probes.reach; }
+};
+
+#endif
@@ -0,0 +1,42 @@
+// bump allocator for the scene objects of one environment
+
+#include <algorithm>
+#include <cstdint>
+
+#include "arena.h"
+
+// constructor
+scene_arena::scene_arena() {}
+
+// bytes aligned to align from the last block, or from a new one if they don't fit
+void *scene_arena::allocate(size_t bytes, size_t align) {
+    size_t pad = next ? (align - reinterpret_cast<uintptr_t>(next) % align) % align : 0;
+    if (!next || pad + bytes > left) {
+        size_t size = std::max(block_size, bytes + align);
+        blocks.emplace_back(new char[size]);
+        next = blocks.back().get();
+        left = size;
+        pad = (align - reinterpret_cast<uintptr_t>(next) % align) % align;
+    }
+    void *memory = next + pad;
+    next += pad + bytes;
+    left -= pad + bytes;
+    num_bytes += bytes;
+    return memory;
+}
+
+// free every object at once. whatever pointers and spans were handed out are invalid after this
+void scene_arena::reset() {
+    blocks.clear();
+    next = nullptr;
+    left = 0;
+    num_bytes = 0;
+}
+
+size_t scene_arena::get_num_bytes() const {
+    return this->num_bytes;
+}
+
+size_t scene_arena::get_num_blocks() const {
+    return this->blocks.size();
+}
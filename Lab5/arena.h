@@ -0,0 +1,67 @@
+// bump allocator for the scene objects of one environment: walls, obstacles and the goal. objects
+// are carved out of large blocks and never freed one by one; the arena frees all of them at once
+// when it is reset or destroyed, so tearing an environment down leaks nothing. only for types
+// that need no destructor, which Object and Wall don't
+#ifndef ARENA
+#define ARENA
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// n contiguous objects handed out by the arena, valid until it is reset
+template <class T>
+class arena_span {
+    T *first{nullptr};
+    size_t count{0};
+    public:
+        // constructor
+        arena_span() {}
+        arena_span(T *first, size_t count): first(first), count(count) {}
+        // functions
+        T& operator[](size_t i) const { return first[i]; }
+        T *begin() const { return first; }
+        T *end() const { return first + count; }
+        // getters
+        size_t size() const { return this->count; }
+        bool empty() const { return this->count == 0; }
+};
+
+class scene_arena {
+    static constexpr size_t block_size = 16384;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char *next{nullptr};                // free space in the last block
+    size_t left{0};
+    size_t num_bytes{0};                // handed out since the last reset
+    private:
+        void *allocate(size_t, size_t);
+    public:
+        // constructor
+        scene_arena();
+        scene_arena(const scene_arena&) = delete;
+        scene_arena& operator=(const scene_arena&) = delete;
+        // functions
+        template <class T, class... Args>
+        T *make(Args&&... args) {
+            static_assert(std::is_trivially_destructible<T>::value, "the arena never runs destructors");
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+        template <class T>
+        arena_span<T> make_array(size_t n) {
+            static_assert(std::is_trivially_destructible<T>::value, "the arena never runs destructors");
+            T *first = static_cast<T*>(allocate(n*sizeof(T), alignof(T)));
+            for (size_t i = 0; i < n; i++) {
+                new (first + i) T();
+            }
+            return arena_span<T>(first, n);
+        }
+        void reset();
+        // getters
+        size_t get_num_bytes() const;
+        size_t get_num_blocks() const;
+};
+
+#endif
@@ -0,0 +1,90 @@
+// benchmark for the ground truth setup: builds the environment of config.csv (walls, goal,
+// obstacles, clear_tol) reps times with 1, 2, 4, ... threads, and checks every grid against the
+// one built with 1 thread from the same seed
+// usage: bench_setup [--reps <n>] [--max-threads <n>]
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "utils.h"
+#include "task_pool.h"
+
+// same environment as lab5's main parameters
+const int env_width {800}, env_height {800};
+const int radius {10};
+const int min_obj_size {30};
+const int max_obj_size {40};
+const int occupancy_tol {35};
+int tol{5+radius};
+int num_objects {6};
+
+// build one environment, returns the time it took in ms
+double build(grid_util& grid, const std::tuple<std::string, bool, int, int>& config, unsigned seed) {
+    random_generator rand_gen(seed);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (std::get<3>(config) == 4) {
+        grid.create_walls(std::get<0>(config));
+    }
+    else {
+        grid.create_angled_walls(std::get<0>(config));
+    }
+    grid.spawn_object(rand_gen, occupancy_tol, 2);
+    grid.create_objects_wall(rand_gen, occupancy_tol, tol, radius, num_objects);
+    grid.clear_tol();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char const *argv[])
+{
+    std::tuple<std::string, bool, int, int> config = read_csv();
+    int reps = 20;
+    int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    bool valid = true;
+    for (int i = 1; i+1 < argc; i++) {
+        if (std::string(argv[i]) == "--reps") {
+            valid = parse_int(argv[i+1], 1, reps);
+        }
+        else if (std::string(argv[i]) == "--max-threads") {
+            valid = parse_int(argv[i+1], 1, max_threads);
+        }
+        if (!valid) {
+            std::cerr << "usage: " << argv[0] << " [--reps <n>] [--max-threads <n>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<std::vector<std::vector<int>>> serial(reps);
+    double serial_ms = 0;
+    std::cout << std::fixed << std::setprecision(2);
+    // 1, 2, 4, ... and max_threads last
+    for (int threads = 1; ; threads = std::min(2*threads, max_threads)) {
+        task_pool pool(threads);
+        double total_ms = 0;
+        int mismatches = 0;
+        for (int r = 0; r < reps; r++) {
+            grid_util grid(env_width, env_height, min_obj_size, max_obj_size, radius, tol);
+            grid.set_pool(&pool);
+            total_ms += build(grid, config, r + 1);
+            if (threads == 1) {
+                serial[r] = grid.get_grid();
+            }
+            else {
+                mismatches += (grid.get_grid() != serial[r]);
+            }
+        }
+        if (threads == 1) {
+            serial_ms = total_ms;
+        }
+        std::cout << std::setw(3) << threads << " threads: " << std::setw(8) << total_ms/reps << " ms per environment, "
+            << std::setw(5) << serial_ms/total_ms << "x, " << mismatches << " grids differ from 1 thread" << std::endl;
+        if (threads >= max_threads) {
+            break;
+        }
+    }
+    return 0;
+}
@@ -1,3 +1,5 @@
+#include <chrono>
+#include <climits>
 #include <cmath>
 #include <deque>
 #include <fstream>
@@ -9,6 +11,33 @@
 #include <vector>
 #include "utils.h"
 #include "render.h"
+#include "scene.h"
+#include "trajectory.h"
+#include "motion.h"
+#include "nav_machine.h"
+#include "task_pool.h"
+
+// controller states and the events that move between them, see nav_machine.h.
+// add your controller's states and events here and extend the table
+enum nav_state : uint8_t {
+    NAV_TO_GOAL,                        // example: heading for the goal
+    NAV_DONE,
+    NUM_NAV_STATES
+};
+
+enum nav_event : uint8_t {
+    EV_FINISHED,
+    NUM_NAV_EVENTS
+};
+
+const char *const nav_state_names[NUM_NAV_STATES] = {"to goal", "done"};
+
+const uint8_t STAY = nav_machine::stay;
+const uint8_t nav_table[NUM_NAV_STATES][NUM_NAV_EVENTS] = {
+    //                FINISHED
+    /* to goal */    {NAV_DONE},
+    /* done */       {STAY}
+};
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //+++++++++++++++++++Modify my_robot class here+++++++++++++++++++++++
@@ -26,6 +55,9 @@ class my_robot: public Object {
             grid = std::vector<std::vector<int>>(env_height, std::vector<int>(env_width, -1));
         }
 
+        // controller state, with per state profiling
+        nav_machine nav{&nav_table[0][0], nav_state_names, NUM_NAV_STATES, NUM_NAV_EVENTS, NAV_TO_GOAL};
+
         // save grid
         void save_grid_csv() {
             std::string filename = "grid_pred.csv";
@@ -80,6 +112,12 @@ const int occupancy_tol {35};                   //Minimum distance between all o
 int lidar_range{40};                            //Lidar range, radiating from center of robot
 int tol{5+radius};                              //How much closer from farthest lidar range should robot stop in front of obstacle?
 int num_objects {6};                            //Number of objects in environment
+int max_speed{1};                               //Pixels the robot may move per time step
+bool split_view{true};                          //Play back ground truth and map side by side in one window
+std::string frame_prefix{""};                   //Write the playback as <prefix>_<step>.png instead of opening windows (or --frames <prefix>)
+int frame_stride{50};                           //Steps between exported frames (or --frame-stride <n>)
+int num_trials{0};                              //Batch mode: run this many headless trials and print a summary (or --trials <n>)
+int num_threads{0};                             //Threads for trials and grid passes, 0 for one per core (or --threads <n>)
 
 // Grid utility class
 grid_util grid(env_width, env_height, min_obj_size, max_obj_size, radius, tol);
@@ -88,7 +126,7 @@ grid_util grid(env_width, env_height, min_obj_size, max_obj_size, radius, tol);
 random_generator rand_gen;
 
 // Vector of robot positions
-std::vector<std::vector<int>> robot_pos;
+trajectory robot_pos;
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++DEFINE ANY GLOBAL VARIABLES/FUNCTIONS HERE+++++++++++++++
@@ -98,6 +136,96 @@ std::vector<std::vector<int>> robot_pos;
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+struct trial_result {
+    int iterations{0};
+    bool reached_goal{false};
+    int obstacle_steps{0};              // steps the robot's box overlapped an obstacle's
+    float wall_accuracy{0}, accuracy{0};
+};
+
+// one headless trial: its own environment, obstacles, goal and robot, all drawn from seed, then
+// the example controller from main. keep the two in step when the controller changes
+trial_result run_trial(const std::tuple<std::string, bool, int, int>& config, unsigned seed, task_pool& pool) {
+    trial_result result;
+    grid_util trial_grid(env_width, env_height, min_obj_size, max_obj_size, radius, tol);
+    trial_grid.set_pool(&pool);
+    random_generator trial_gen(seed);
+
+    scene_store world;
+    if (std::get<3>(config) == 4) {
+        world.add_walls(trial_grid.create_walls(std::get<0>(config)), false);
+    }
+    else {
+        world.add_walls(trial_grid.create_angled_walls(std::get<0>(config)), true);
+    }
+    Object* goal = trial_grid.spawn_object(trial_gen, occupancy_tol, 2);
+    if (!goal) {
+        return result;
+    }
+    goal->val = 2;
+    world.add(SCENE_GOAL, *goal);
+    world.add_all(SCENE_OBSTACLE, trial_grid.create_objects_wall(trial_gen, occupancy_tol, tol, radius, num_objects));
+    trial_grid.clear_tol();
+    trial_grid.build_runs(1);
+
+    my_robot robot(2*radius, 2*radius, env_width, env_height,
+        lidar_range, tol, trial_grid.get_min_y(), trial_grid.get_max_y());
+    // respawn in the band of the Object constructor, which draws from a generator of its own
+    robot.x = trial_gen.create_random(env_width/2 - 50, env_width/2 + 50);
+    robot.y = trial_gen.create_random(trial_grid.get_max_y() - 4*radius - tol, trial_grid.get_max_y() - 2*radius - tol);
+
+    line_motion motion(robot.x, robot.y, goal->x + goal->width/2 - radius, goal->y + goal->height/2 - radius, max_speed);
+    while (result.iterations < 10000) {
+        result.iterations++;
+        if (!motion.step(robot.x, robot.y)) {
+            result.reached_goal = true;
+            break;
+        }
+        result.obstacle_steps += world.first_overlap(SCENE_OBSTACLE, robot.x, robot.y, robot.width, robot.height) >= 0;
+    }
+    result.wall_accuracy = trial_grid.wall_accuracy(robot.grid);
+    result.accuracy = trial_grid.grid_accuracy(robot.grid);
+    return result;
+}
+
+// batch mode: num_trials trials fanned out across the pool. the seeds are drawn up front, so a
+// trial doesn't depend on which thread runs it. a trial's grid passes split into row bands on the
+// same pool, which threads that have run out of trials steal
+int run_trials(const std::tuple<std::string, bool, int, int>& config, task_pool& pool) {
+    std::vector<unsigned> seeds(num_trials);
+    for (unsigned& seed: seeds) {
+        seed = rand_gen.create_random(0, INT_MAX);
+    }
+    std::vector<trial_result> results(num_trials);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pool.parallel_for(0, num_trials, 1, [&](int lo, int hi) {
+        for (int t = lo; t < hi; t++) {
+            results[t] = run_trial(config, seeds[t], pool);
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int reached = 0, hit = 0;
+    double iterations = 0, wall_accuracy = 0, accuracy = 0;
+    for (const trial_result& result: results) {
+        reached += result.reached_goal;
+        hit += result.obstacle_steps > 0;
+        iterations += result.iterations;
+        wall_accuracy += result.wall_accuracy;
+        accuracy += result.accuracy;
+    }
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "====" << num_trials << " trials on " << pool.get_num_threads() << " threads in " << seconds
+        << " s, " << num_trials/seconds << " trials/s====" << std::endl;
+    std::cout << "Reached the goal: " << reached << " of " << num_trials << std::endl;
+    std::cout << "Drove through an obstacle: " << hit << " of " << num_trials << std::endl;
+    std::cout << "Mean iterations: " << iterations/num_trials << std::endl;
+    std::cout << "Mean percent of walls correctly mapped: " << wall_accuracy/num_trials*100.0 << "%" << std::endl;
+    std::cout << "Mean percent of environment correctly mapped: " << accuracy/num_trials*100.0 << "%" << std::endl;
+    return 0;
+}
+
 int main(int argc, char const *argv[])
 {
 
@@ -106,17 +234,50 @@ int main(int argc, char const *argv[])
     // read config file
     std::tuple<std::string, bool, int, int> config = read_csv();
 
+    // command line options. counts must be whole numbers, at least 1 (0 is allowed for --threads,
+    // one per core)
+    bool valid = true;
+    for (int i = 1; i+1 < argc; i++) {
+        if (std::string(argv[i]) == "--frames") {
+            frame_prefix = argv[i+1];
+        }
+        else if (std::string(argv[i]) == "--frame-stride") {
+            valid = parse_int(argv[i+1], 1, frame_stride);
+        }
+        else if (std::string(argv[i]) == "--trials") {
+            valid = parse_int(argv[i+1], 1, num_trials);
+        }
+        else if (std::string(argv[i]) == "--threads") {
+            valid = parse_int(argv[i+1], 0, num_threads);
+        }
+        if (!valid) {
+            std::cerr << "usage: " << argv[0] << " [--frames <prefix>] [--frame-stride <n>] [--trials <n>] [--threads <n>]"
+                << std::endl;
+            return 1;
+        }
+    }
+
+    // trials and the grid's full passes share one pool
+    task_pool pool(num_threads);
+    grid.set_pool(&pool);
+    if (num_trials > 0) {
+        return run_trials(config, pool);
+    }
+
     // create the walls
-    std::vector<Object*> objects;
+    std::vector<Object*> walls;
+    // the walls, obstacles and goal by kind, for rendering and geometric queries
+    scene_store world;
     
     // normal perpendicular walls
     if (std::get<3>(config) == 4) {
-        objects = grid.create_walls(std::get<0>(config));
+        walls = grid.create_walls(std::get<0>(config));
     }
     // angled walls
     else {
-        objects = grid.create_angled_walls(std::get<0>(config));
+        walls = grid.create_angled_walls(std::get<0>(config));
     }
+    world.add_walls(walls, std::get<3>(config) != 4);
 
     // create the goal
     Object* goal = grid.spawn_object(rand_gen, occupancy_tol, 2);
@@ -130,14 +291,16 @@ int main(int argc, char const *argv[])
     // create the objects
     std::vector<Object *> obstacles = grid.create_objects_wall(rand_gen, occupancy_tol, tol, radius, num_objects);
 
-    // push obstacles to the list of objects
-    objects.insert(objects.end(), obstacles.begin(), obstacles.end());
-    // insert goal to list of objects
-    objects.push_back(goal);
+    // add obstacles and goal to the scene
+    world.add_all(SCENE_OBSTACLE, obstacles);
+    world.add(SCENE_GOAL, *goal);
 
     // clear the grid of -1 tolerance values
     grid.clear_tol();
 
+    // run lengths of the walls and obstacles (value 1) for grid.clearance queries
+    grid.build_runs(1);
+
     // Uncomment this line to write the grid to csv to see the grid as a csv
     grid.writeGridToCSV("grid.csv");
 
@@ -151,13 +314,16 @@ int main(int argc, char const *argv[])
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++DEFINE ANY LOCAL VARIABLES HERE+++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    // example: integer line from the robot to the centre of the goal
+    line_motion motion(robot.x, robot.y, goal->x + goal->width/2 - radius, goal->y + goal->height/2 - radius, max_speed);
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-    robot_pos.push_back({robot.x, robot.y});
+    robot_pos.push_back(robot.x, robot.y);
     int limit_count = 0;
+    robot.nav.restart_clock();
 
     // run the program indefinitely until robot hits the goal or an obstacle
     while (true)
@@ -165,9 +331,13 @@ int main(int argc, char const *argv[])
         limit_count++;
 
 //+++++++++++++++WRITE YOUR MAIN LOOP CODE HERE++++++++++++++++++++++
-//++++++++++++++EXAMPLE: ROBOT SIMPLY MOVES LEFT+++++++++++++++++++++
+//+++++++EXAMPLE: ROBOT HEADS STRAIGHT FOR THE GOAL, BLIND TO OBSTACLES+++++++
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-        robot.x -= 1;      
+        if (!motion.step(robot.x, robot.y)) {
+            std::cout << "====Example path ended at the goal after " << limit_count << " iterations====" << std::endl;
+            robot.nav.fire(EV_FINISHED);
+            break;
+        }
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -175,23 +345,37 @@ int main(int argc, char const *argv[])
             
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++
         // update position
-        robot_pos.push_back({robot.x, robot.y});
+        robot_pos.push_back(robot.x, robot.y);
+        robot.nav.tick();
 
         if (limit_count>=10000) {
             std::cout << "====Program terminated after " << limit_count << " iterations====" << std::endl;
+            robot.nav.fire(EV_FINISHED);
             break;
         }
 
     }
+    robot.nav.print_profile(std::cout);
 
     float wall_accuracy = grid.wall_accuracy(robot.grid);   // for task 1: outer walls
     float accuracy = grid.grid_accuracy(robot.grid);        // for task 2: entire environment inside walls
     std::cout << std::fixed << std::setprecision(2);        // set precision for printing
     std::cout << "Percent of walls correctly mapped: " << wall_accuracy*100.0 << "%" << std::endl;
     std::cout << "Percent of environment correctly mapped: " << accuracy*100.0 << "%" << std::endl;
-    if (std::get<1>(config)){
-        render_window(robot_pos, objects, robot_init, env_width, env_height, std::get<2>(config));
+    // headless: frames to disk, no windows
+    if (!frame_prefix.empty()) {
+        int frames = export_frames(robot_pos, world, robot.grid, env_width, env_height, radius, lidar_range,
+            frame_stride, frame_prefix);
+        std::cout << frames << " frames written to " << frame_prefix << "_*.png" << std::endl;
+    }
+    else if (std::get<1>(config) && split_view){
+        render_split(robot_pos, world, robot.grid, env_width, env_height, radius, lidar_range, std::get<2>(config));
+    }
+    else {
+        if (std::get<1>(config)){
+            render_window(robot_pos, world, robot_init, env_width, env_height, std::get<2>(config));
+        }
+        render_grid(robot_init, robot_pos, robot.grid, env_width, env_height, radius, lidar_range, std::get<2>(config));
     }
-    render_grid(robot_init, robot_pos, robot.grid, env_width, env_height, radius, lidar_range, std::get<2>(config));
     return 0;
 }
@@ -0,0 +1,85 @@
+// table driven navigation state machine
+
+#include <iomanip>
+
+#include "nav_machine.h"
+
+// constructor. table and names must outlive the machine (static tables in the controller)
+nav_machine::nav_machine(const uint8_t *table, const char *const *names, int num_states, int num_events,
+    int initial):
+    table(table),
+    names(names),
+    num_states(num_states),
+    num_events(num_events),
+    current(initial),
+    steps(num_states, 0),
+    entries(num_states, 0),
+    time(num_states, std::chrono::steady_clock::duration::zero()),
+    mark(std::chrono::steady_clock::now())
+{
+    entries[initial]++;
+}
+
+// time since the last mark goes to the current state
+void nav_machine::charge() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    time[current] += now - mark;
+    mark = now;
+}
+
+// apply event, returns the state after it
+int nav_machine::fire(int event) {
+    uint8_t next = table[current*num_events + event];
+    if (next == stay || next == current) {
+        return current;
+    }
+    charge();
+    current = next;
+    entries[current]++;
+    return current;
+}
+
+// end of a controller step: count it for the current state
+void nav_machine::tick() {
+    charge();
+    steps[current]++;
+}
+
+// don't charge the time since the last tick (e.g. time spent outside the controller) to any state
+void nav_machine::restart_clock() {
+    mark = std::chrono::steady_clock::now();
+}
+
+// steps, entries and time of every state that was entered
+void nav_machine::print_profile(std::ostream& out) const {
+    // the caller's format is put back afterwards
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << "Controller profile:" << std::endl;
+    for (int s = 0; s < num_states; s++) {
+        if (entries[s] == 0) {
+            continue;
+        }
+        out << "  " << std::left << std::setw(16) << names[s] << std::right
+            << std::setw(8) << steps[s] << " steps " << std::setw(6) << entries[s] << " entries "
+            << std::fixed << std::setprecision(3) << std::setw(10) << get_seconds(s)*1000.0 << " ms" << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+int nav_machine::state() const {
+    return this->current;
+}
+
+uint64_t nav_machine::get_steps(int s) const {
+    return this->steps[s];
+}
+
+uint64_t nav_machine::get_entries(int s) const {
+    return this->entries[s];
+}
+
+double nav_machine::get_seconds(int s) const {
+    return std::chrono::duration<double>(this->time[s]).count();
+}
@@ -3,15 +3,17 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include "utils.h"
+#include "scene.h"
+#include "trajectory.h"
 
 #ifndef RENDER
 #define RENDER
 
-sf::RectangleShape draw_object(int, int, int, int);
+sf::RectangleShape draw_object(int, int, int, int, const sf::Color &);
 
 void render_window(
-    std::vector<std::vector<int>> &, 
-    std::vector<Object *> &,
+    const trajectory &, 
+    const scene_store &,
     Object, 
     int, 
     int,
@@ -19,8 +21,21 @@ void render_window(
 
 void render_grid(
     Object, 
+    const trajectory &, 
     std::vector<std::vector<int>>, 
-    std::vector<std::vector<int>>, 
     int, int, int, int, int);
 
+void render_split(
+    const trajectory &,
+    const scene_store &,
+    std::vector<std::vector<int>>,
+    int, int, int, int, int);
+
+int export_frames(
+    const trajectory &,
+    const scene_store &,
+    std::vector<std::vector<int>>,
+    int, int, int, int, int,
+    const std::string &);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+// the scene of one environment, stored by kind
+
+#include <algorithm>
+#include <cmath>
+
+#include "scene.h"
+
+void shape_store::add(int x_, int y_, int w_, int h_, float angle_, bool rotated_) {
+    x.push_back(x_);
+    y.push_back(y_);
+    w.push_back(w_);
+    h.push_back(h_);
+    angle.push_back(angle_);
+    rotated.push_back(rotated_);
+    if (!rotated_) {
+        min_x.push_back(x_);
+        min_y.push_back(y_);
+        max_x.push_back(x_ + w_);
+        max_y.push_back(y_ + h_);
+        return;
+    }
+    // bounding box of the four corners of [-w/2, w/2] x [0, h] turned about (x, y)
+    float c = std::cos(angle_*(M_PI / 180.f)), s = std::sin(angle_*(M_PI / 180.f));
+    float corner_x[2] = {-w_/2.f, w_/2.f}, corner_y[2] = {0.f, (float)h_};
+    float lo_x = x_, hi_x = x_, lo_y = y_, hi_y = y_;
+    for (float cx: corner_x) {
+        for (float cy: corner_y) {
+            float px = x_ + cx*c - cy*s, py = y_ + cx*s + cy*c;
+            lo_x = std::min(lo_x, px), hi_x = std::max(hi_x, px);
+            lo_y = std::min(lo_y, py), hi_y = std::max(hi_y, py);
+        }
+    }
+    min_x.push_back(std::floor(lo_x));
+    min_y.push_back(std::floor(lo_y));
+    max_x.push_back(std::ceil(hi_x));
+    max_y.push_back(std::ceil(hi_y));
+}
+
+void shape_store::clear() {
+    for (std::vector<int> *field: {&x, &y, &w, &h, &min_x, &min_y, &max_x, &max_y}) {
+        field->clear();
+    }
+    angle.clear();
+    rotated.clear();
+}
+
+size_t shape_store::size() const {
+    return this->x.size();
+}
+
+// a box object: a perpendicular wall, an obstacle or the goal
+void scene_store::add(scene_kind kind, const Object& obj) {
+    stores[kind].add(obj.x, obj.y, obj.width, obj.height, 0.f, false);
+}
+
+// the walls of create_walls (boxes), or of create_angled_walls (angled, all of them Wall)
+void scene_store::add_walls(const std::vector<Object*>& walls, bool angled) {
+    for (Object *obj: walls) {
+        if (angled) {
+            const Wall *wall = static_cast<const Wall*>(obj);
+            stores[SCENE_WALL].add(wall->x, wall->y, wall->width, wall->height, wall->angle, true);
+        }
+        else {
+            add(SCENE_WALL, *obj);
+        }
+    }
+}
+
+void scene_store::add_all(scene_kind kind, const std::vector<Object*>& objects) {
+    for (Object *obj: objects) {
+        add(kind, *obj);
+    }
+}
+
+// index of the first object of kind whose bounding box overlaps the w x h box at (x, y), -1 if none
+int scene_store::first_overlap(scene_kind kind, int x, int y, int w, int h) const {
+    const shape_store& store = stores[kind];
+    for (size_t i = 0; i < store.size(); i++) {
+        if (store.min_x[i] <= x + w && x <= store.max_x[i] && store.min_y[i] <= y + h && y <= store.max_y[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void scene_store::clear() {
+    for (shape_store& store: stores) {
+        store.clear();
+    }
+}
+
+const shape_store& scene_store::get(scene_kind kind) const {
+    return this->stores[kind];
+}
+
+size_t scene_store::size() const {
+    size_t total = 0;
+    for (const shape_store& store: stores) {
+        total += store.size();
+    }
+    return total;
+}
@@ -0,0 +1,48 @@
+// the scene of one environment, one store per kind of object: walls, obstacles and goals. each
+// store is a structure of arrays, so a pass over, say, the obstacles' boxes reads contiguous ints
+// only, and what an object is follows from the store it is in rather than from a virtual type()
+// or a dynamic_cast. the objects themselves stay with the grid's arena; the scene keeps copies
+#ifndef SCENE
+#define SCENE
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "utils.h"
+
+enum scene_kind : uint8_t {
+    SCENE_WALL,
+    SCENE_OBSTACLE,
+    SCENE_GOAL,
+    NUM_SCENE_KINDS
+};
+
+// one kind of object. a box has its top left corner at (x, y). a rotated shape (an angled wall)
+// is w x h turned by angle degrees about (x, y), the middle of its top edge, the way SFML draws it
+struct shape_store {
+    std::vector<int> x, y, w, h;
+    std::vector<float> angle;
+    std::vector<uint8_t> rotated;
+    std::vector<int> min_x, min_y, max_x, max_y;    // bounding boxes, inclusive like occupy_grid
+    // functions
+    void add(int, int, int, int, float, bool);
+    void clear();
+    // getters
+    size_t size() const;
+};
+
+class scene_store {
+    shape_store stores[NUM_SCENE_KINDS];
+    public:
+        // functions
+        void add(scene_kind, const Object&);
+        void add_walls(const std::vector<Object*>&, bool);
+        void add_all(scene_kind, const std::vector<Object*>&);
+        int first_overlap(scene_kind, int, int, int, int) const;
+        void clear();
+        // getters
+        const shape_store& get(scene_kind) const;
+        size_t size() const;
+};
+
+#endif
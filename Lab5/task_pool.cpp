@@ -0,0 +1,138 @@
+// work stealing task pool
+
+#include <algorithm>
+
+#include "task_pool.h"
+
+// the pool and queue of the calling thread, if it is one of a pool's workers
+static thread_local const task_pool *current_pool = nullptr;
+static thread_local int current_queue = -1;
+
+// constructor
+task_pool::task_pool(int threads) {
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_queues = threads;
+    queues.reset(new task_queue[num_queues]);
+    for (int i = 0; i < threads - 1; i++) {
+        workers.emplace_back(&task_pool::worker_loop, this, i);
+    }
+}
+
+task_pool::~task_pool() {
+    {
+        std::lock_guard<std::mutex> guard(idle_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+}
+
+// workers use their own queue, every other thread shares the last one
+int task_pool::own_queue() const {
+    return (current_pool == this) ? current_queue : num_queues - 1;
+}
+
+void task_pool::push(std::function<void()> task) {
+    {
+        task_queue& queue = queues[own_queue()];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued++;
+    // a worker checks queued under idle_lock before it sleeps, so it can't miss this
+    { std::lock_guard<std::mutex> guard(idle_lock); }
+    wake.notify_one();
+}
+
+// run the newest task of the own queue, or else steal the oldest of another. false if all are empty
+bool task_pool::run_one() {
+    int own = own_queue();
+    std::function<void()> task;
+    {
+        task_queue& queue = queues[own];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+    }
+    unsigned first = next_victim.fetch_add(1);
+    for (int k = 0; !task && k < num_queues; k++) {
+        int victim = (first + k) % num_queues;
+        if (victim == own) {
+            continue;
+        }
+        task_queue& queue = queues[victim];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) {
+        return false;
+    }
+    queued--;
+    task();
+    return true;
+}
+
+void task_pool::worker_loop(int queue) {
+    current_pool = this;
+    current_queue = queue;
+    while (true) {
+        if (run_one()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(idle_lock);
+        wake.wait(guard, [&] { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+// fn(lo, hi) over [begin, end) split into chunks of at least grain, returns once all are done.
+// the chunks are contiguous and cover the range exactly once, in no particular order
+void task_pool::parallel_for(int begin, int end, int grain, const std::function<void(int, int)>& fn) {
+    int n = end - begin;
+    if (n <= 0) {
+        return;
+    }
+    // a few chunks per thread, so the threads that finish early have something to steal
+    int chunks = std::min((n + std::max(grain, 1) - 1) / std::max(grain, 1), 4*this->get_num_threads());
+    if (workers.empty() || chunks <= 1) {
+        fn(begin, end);
+        return;
+    }
+    std::atomic<int> remaining{chunks};
+    for (int c = 0; c < chunks; c++) {
+        int lo = begin + (long)n*c/chunks;
+        int hi = begin + (long)n*(c + 1)/chunks;
+        push([this, &fn, &remaining, lo, hi] {
+            fn(lo, hi);
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                // the last chunk. the caller checks remaining under idle_lock before it sleeps
+                { std::lock_guard<std::mutex> guard(idle_lock); }
+                wake.notify_all();
+            }
+        });
+    }
+    // help rather than block: the chunks may be queued behind this very thread. once nothing is
+    // queued, sleep until a task is pushed or the last chunk is done
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (run_one()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(idle_lock);
+        wake.wait(guard, [&] { return remaining.load(std::memory_order_acquire) == 0 || queued.load() > 0; });
+    }
+}
+
+int task_pool::get_num_threads() const {
+    return this->workers.size() + 1;
+}
@@ -0,0 +1,47 @@
+// work stealing task pool. every thread of the pool has its own deque of tasks: it pushes and
+// pops at the back (newest first, still warm in cache), and a thread with nothing to do steals
+// from the front of another's. a thread waiting for its tasks runs queued tasks meanwhile, so
+// tasks may wait on tasks of their own, like trials that split their grid passes into row bands
+#ifndef TASK_POOL
+#define TASK_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class task_pool {
+    struct task_queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+    std::vector<std::thread> workers;
+    std::unique_ptr<task_queue[]> queues;   // one per worker, and the last for outside threads
+    int num_queues{1};
+    std::atomic<int> queued{0};             // tasks in the queues, not yet taken
+    std::atomic<unsigned> next_victim{0};   // where the next steal starts looking
+    std::mutex idle_lock;
+    std::condition_variable wake;           // new tasks, a parallel_for done, or stopping
+    bool stopping{false};
+    private:
+        int own_queue() const;
+        void push(std::function<void()>);
+        bool run_one();
+        void worker_loop(int);
+    public:
+        // constructor. threads counts the caller, which works too. 0 for one per core
+        task_pool(int threads = 0);
+        ~task_pool();
+        task_pool(const task_pool&) = delete;
+        task_pool& operator=(const task_pool&) = delete;
+        // functions
+        void parallel_for(int, int, int, const std::function<void(int, int)>&);
+        // getters
+        int get_num_threads() const;
+};
+
+#endif
@@ -7,14 +7,19 @@
 #include <random>
 #include <string>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <cmath>
 #include <memory>
+#include <mutex>
 #include <cassert>
 
 #include "utils.h"
+#include "task_pool.h"
 
 random_generator::random_generator(): gen(rd()) {}
+// seeded, to reproduce a run
+random_generator::random_generator(unsigned seed): gen(seed) {}
 
 int random_generator::create_random(int lower_bnd, int upper_bnd) {
     std::uniform_int_distribution<> distr(lower_bnd, upper_bnd); // define the range
@@ -30,6 +35,23 @@ std::string trim(const std::string& str) {
     return strBegin == std::string::npos ? "" : str.substr(strBegin, strRange);
 }
 
+// a command line number: true and value set if all of str is an int of at least min_value
+bool parse_int(const std::string& str, int min_value, int& value) {
+    size_t pos = 0;
+    int parsed = 0;
+    try {
+        parsed = std::stoi(str, &pos);
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    if (pos != str.size() || parsed < min_value) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
 std::tuple<std::string, bool, int, int> read_csv() {
     // tuple to store the return values: (csv_file, render_ground_truth, render_speed)
     std::tuple<std::string, bool, int, int> config_values;
@@ -253,7 +275,6 @@ std::vector<Object *> grid_util::create_objects(random_generator &rand_gen, int
     int max_iter = 0;
     int min_x, min_y, max_x, max_y;
     for (int i = 0; i < num_objects; i++) {
-        Object *obj = new Object;   //allocate new
         // set min and max for subgrids to spawn in. Based on subgrid 0, the one with lowest occupancy
         min_x = this->subgrids[0][1] < tol ? tol: this->subgrids[0][1];
         min_y = this->subgrids[0][2] < tol ? tol: this->subgrids[0][2];
@@ -289,6 +310,7 @@ std::vector<Object *> grid_util::create_objects(random_generator &rand_gen, int
             limit_reached = false;
             continue;
         }
+        Object *obj = this->arena.make<Object>();
         obj->x = obj_x;
         obj->y = obj_y;
         obj->width = obj_width;
@@ -337,7 +359,6 @@ Object* grid_util::spawn_object(random_generator &rand_gen, const int& o_tol, in
     bool obj_found_l{false};
     bool obj_found_r{false};
     int limit_reached{false};
-    Object *obj = new Object;   //allocate new
     int max_iter=0;
     int obj_x, obj_y, obj_width, obj_height;
 
@@ -365,7 +386,6 @@ Object* grid_util::spawn_object(random_generator &rand_gen, const int& o_tol, in
         int i_l{399};   //counter from middle to left
         int left_wall{0};   //min x (i.e. left side of wall)
         for (int i_r=400; i_r<this->grid.size(); i_r++) {   //i_l is counter from middle to right
-            Object *obj = new Object;   //allocate new
             if (this->grid[i_r][obj_y]!=0) {
                 obj_found_r = true;
             }
@@ -410,6 +430,7 @@ Object* grid_util::spawn_object(random_generator &rand_gen, const int& o_tol, in
         limit_reached = false;
         return nullptr;
     }
+    Object *obj = this->arena.make<Object>();
     obj->x = obj_x;
     obj->y = obj_y;
     obj->width = obj_width;
@@ -421,36 +442,36 @@ Object* grid_util::spawn_object(random_generator &rand_gen, const int& o_tol, in
 
 //for a given y, find the x bounds
 void grid_util::find_x_bounds() {
-    bool wall_found_l{false};
-    bool wall_found_r{false};
-
-    for (int j=this->min_y; j<this->max_y; j++) {
-        int i_l{399};
-        int i_r;
-        for (int i=400; i<this->grid.size(); i++) {
-            if (this->grid[i][j]) {
-                wall_found_r = true;
-            }
-            if (this->grid[i_l][j]) {
-                wall_found_l = true;
-            }
-            if (wall_found_l && wall_found_r) {
-                i_r = i;
-                break;
-            }
-            if (wall_found_r) {
-                i_r = i;
-            }
-            if (!wall_found_l) {
-                i_l--;
+    // every y is independent: size x_range first, then fill it in bands
+    size_t first = this->x_range.size();
+    this->x_range.resize(first + std::max(this->max_y - this->min_y, 0));
+    this->for_bands(this->min_y, this->max_y, [&](int lo, int hi) {
+        for (int j=lo; j<hi; j++) {
+            bool wall_found_l{false};
+            bool wall_found_r{false};
+            int i_l{399};
+            int i_r;
+            for (int i=400; i<this->grid.size(); i++) {
+                if (this->grid[i][j]) {
+                    wall_found_r = true;
+                }
+                if (this->grid[i_l][j]) {
+                    wall_found_l = true;
+                }
+                if (wall_found_l && wall_found_r) {
+                    i_r = i;
+                    break;
+                }
+                if (wall_found_r) {
+                    i_r = i;
+                }
+                if (!wall_found_l) {
+                    i_l--;
+                }
             }
+            this->x_range[first + j - this->min_y] = {i_l, i_r};
         }
-
-        this->x_range.push_back({i_l, i_r});
-        // reset
-        wall_found_l = false;
-        wall_found_r = false;
-    }
+    });
 }
 
 // occupy grid with angled walls
@@ -576,9 +597,7 @@ void grid_util::occupy_grid_wall (Wall *wall_prev, Wall *wall)
     // top triangle
     int x_min = x2_l, x_max = x2_r;
     for (int j = y2; j>y1; j--) {
-        for (int i = x_min; i<=x_max; i++) {
-            this->grid[i][j] = 1;
-        }
+        this->spans.push_back({j, x_min, x_max, 1});
         // reduce by 1 pixel both sides
         x_min += 1;
         x_max -= 1;
@@ -587,9 +606,7 @@ void grid_util::occupy_grid_wall (Wall *wall_prev, Wall *wall)
     // bottom triangle
     x_min = x3_l, x_max = x3_r;
     for (int j = y3; j<y4; j++) {
-        for (int i = x_min; i<=x_max; i++) {
-            this->grid[i][j] = 1;
-        }
+        this->spans.push_back({j, x_min, x_max, 1});
         // reduce by 1 pixel both sides
         x_min += 1;
         x_max -= 1;
@@ -598,9 +615,7 @@ void grid_util::occupy_grid_wall (Wall *wall_prev, Wall *wall)
     // middle section
     x_min = x2_l, x_max = x2_r;
     for (int j = y2; j <= y3; j++) {
-        for (int i = x_min; i <= x_max; i++) {
-            this->grid[i][j] = 1;
-        }
+        this->spans.push_back({j, x_min, x_max, 1});
         // shift one to the right
         if (wall->angle==45.0 || wall->angle==225.0) {
             x_min+=1, x_max+=1;
@@ -610,6 +625,9 @@ void grid_util::occupy_grid_wall (Wall *wall_prev, Wall *wall)
             x_min-=1, x_max-=1;
         }
     }
+    if (!this->defer_fills) {
+        this->fill_spans();
+    }
 } 
 
 // Occupy grid with values. -1 for tolerance bounds, 1 for robot, 2 for obstacles, 3 for goal
@@ -623,18 +641,18 @@ void grid_util::occupy_grid (int tol, int x, int y, int obj_width, int obj_heigh
     int max_bnd_x = (env_width < x+obj_width+tol) ? env_width : x+obj_width+tol;
     int max_bnd_y = (env_height < y+obj_height+tol) ? env_height : y+obj_height+tol;
 
-    for (int i=min_bnd_x; i<max_bnd_x; i++) {
-        for (int j=min_bnd_y; j<max_bnd_y; j++) {
-            if ((i<x) || (j<y)) {
-                grid[i][j] = -1;
-            }
-            else if ((i>x+obj_width) || (j>y+obj_height)) {
-                grid[i][j] = -1;
-            }
-            else {
-                grid[i][j] = val;
-            }
+    // per y: the tolerance band (-1) left and right of the object, the object (val) in between
+    for (int j=min_bnd_y; j<max_bnd_y; j++) {
+        if ((j<y) || (j>y+obj_height)) {
+            this->spans.push_back({j, min_bnd_x, max_bnd_x-1, -1});
+            continue;
         }
+        this->spans.push_back({j, min_bnd_x, std::min(x-1, max_bnd_x-1), -1});
+        this->spans.push_back({j, std::max(x, min_bnd_x), std::min(x+obj_width, max_bnd_x-1), val});
+        this->spans.push_back({j, std::max(x+obj_width+1, min_bnd_x), max_bnd_x-1, -1});
+    }
+    if (!this->defer_fills) {
+        this->fill_spans();
     }
     // check which subgrids the object occupies. An object can occupy multiple subgrids
     bool x_intersect, y_intersect;
@@ -655,6 +673,31 @@ void grid_util::occupy_grid (int tol, int x, int y, int obj_width, int obj_heigh
     }
 }
 
+// write the pending spans to the grid, in bands of rows. every band applies the spans in the
+// order they were made, clipped to its rows, so the grid is the same as filling them one by one
+void grid_util::fill_spans() {
+    if (this->spans.empty()) {
+        return;
+    }
+    int lo_x = this->env_width, hi_x = 0;
+    for (const grid_span& span: this->spans) {
+        if (span.x_min <= span.x_max) {
+            lo_x = std::min(lo_x, span.x_min);
+            hi_x = std::max(hi_x, span.x_max + 1);
+        }
+    }
+    // bands of at least 128 rows, so a small fill (an obstacle) stays on this thread
+    this->for_bands(lo_x, hi_x, [&](int lo, int hi) {
+        for (const grid_span& span: this->spans) {
+            int i_end = std::min(span.x_max, hi - 1);
+            for (int i = std::max(span.x_min, lo); i <= i_end; i++) {
+                this->grid[i][span.y] = span.val;
+            }
+        }
+    }, 128);
+    this->spans.clear();
+}
+
 // check if portion of grid is occupied before spawning an object
 bool grid_util::is_occupied (int tol, int x, int y, int width, int height) {
 
@@ -761,6 +804,57 @@ int grid_util::is_collision (Object robot) {
     return 0;
 }
 
+// precompute, for every cell, how many cells of value block_value follow it in a row along each
+// direction (0 if the cell itself is not blocking). call again whenever the grid changes
+void grid_util::build_runs(int block_value) {
+    for (int d = 0; d < 4; d++) {
+        runs[d] = std::vector<uint16_t>(env_width*env_height, 0);
+    }
+    for (int i = 0; i < env_width; i++) {
+        for (int j = 0; j < env_height; j++) {
+            // -x and -y runs from the cells before, +x and +y from the cells after
+            int ib = env_width - 1 - i;
+            int jb = env_height - 1 - j;
+            if (grid[i][j] == block_value) {
+                runs[1][i*env_height + j] = 1 + (i > 0 ? runs[1][(i-1)*env_height + j] : 0);
+                runs[3][i*env_height + j] = 1 + (j > 0 ? runs[3][i*env_height + j - 1] : 0);
+            }
+            if (grid[ib][jb] == block_value) {
+                runs[0][ib*env_height + jb] = 1 + (ib < env_width-1 ? runs[0][(ib+1)*env_height + jb] : 0);
+                runs[2][ib*env_height + jb] = 1 + (jb < env_height-1 ? runs[2][ib*env_height + jb + 1] : 0);
+            }
+        }
+    }
+}
+
+// how far the object must move along (dx, dy) (one of (+-1, 0), (0, +-1)) until none of its four
+// corners is on a blocking cell. 0 if it is clear already, -1 if it would leave the environment
+// first. each pass jumps past the longest run under a corner, so the answer takes a few lookups
+// instead of a walk one pixel at a time
+int grid_util::clearance(const Object& obj, int dx, int dy) const {
+    const std::vector<uint16_t>& run = runs[dx > 0 ? 0 : dx < 0 ? 1 : dy > 0 ? 2 : 3];
+    int corner_x[2] = {obj.x, obj.x + obj.width - 1};
+    int corner_y[2] = {obj.y, obj.y + obj.height - 1};
+    int d = 0;
+    while (true) {
+        int jump = 0;
+        for (int cx: corner_x) {
+            for (int cy: corner_y) {
+                int x = cx + d*dx;
+                int y = cy + d*dy;
+                if (x < 0 || x >= env_width || y < 0 || y >= env_height) {
+                    return -1;
+                }
+                jump = std::max<int>(jump, run[x*env_height + y]);
+            }
+        }
+        if (jump == 0) {
+            return d;
+        }
+        d += jump;
+    }
+}
+
 // function to write a nested vector (grid) to a CSV file. In case students want to analyze the grid as csv
 void grid_util::writeGridToCSV(const std::string& filename) {
     std::ofstream file(filename);
@@ -842,11 +936,14 @@ std::vector<Object*> grid_util::create_walls (std::string file_name) {
     std::vector<Object*> walls;
 
     std::vector<std::vector<float>> data = this->read_csv(file_name, 4);
+    arena_span<Object> wall_objects = this->arena.make_array<Object>(data.size());
     int thick;
+    // collect the walls' cells, then fill them all in one pass
+    this->defer_fills = true;
     // Print out the nested vector to check the data
     for (const auto& vec : data) {
         // std::cout << "x: " << vec[0] << ", y: " << vec[1] << ", width: " << vec[2] << ", height: " << vec[3] << std::endl;
-        Object* wall = new Object;
+        Object* wall = &wall_objects[walls.size()];
         wall->x = vec[0];
         wall->y = vec[1];
         wall->width = vec[2];
@@ -862,6 +959,8 @@ std::vector<Object*> grid_util::create_walls (std::string file_name) {
         }
         thick = wall->height;
     }
+    this->defer_fills = false;
+    this->fill_spans();
     // subtract wall thickness to get min/max y
     this->min_y += thick;
     this->max_y -= thick;
@@ -877,16 +976,23 @@ std::vector<Object*> grid_util::create_angled_walls (std::string file_name) {
 
     std::vector<std::vector<float>> data = this->read_csv(file_name, 3);
 
-    Wall default_wall, default_wall_r;
-    Wall* wall_prev = &default_wall;  // use Wall* to store the previous wall
+    // the render walls live in the arena; the adjusted walls are only needed until the next one
+    arena_span<Wall> walls = this->arena.make_array<Wall>(data.size());
+    Wall default_wall_r;
+    Wall adjusted, adjusted_prev;
+    Wall* wall_prev = &adjusted_prev;  // use Wall* to store the previous wall
     Wall* wall_prev_r = &default_wall_r;  // use Wall* to store the previous render wall
     int dx, dy; // (x, y) corner of previous wall. corresponds to (x+width/2, y) from origin if it was 0 degree wall
     int thick;
+    // each wall's corners follow from the one before, so the walls are laid out in order. their
+    // cells are only collected meanwhile, and filled in bands at the end
+    this->defer_fills = true;
     for (auto vec = data.begin(); vec != data.end(); vec++) {
-        Wall* wall = new Wall((*vec)[0], (*vec)[1], (*vec)[2]);  // dynamically allocate Wall
-        Wall *wall_r;
+        adjusted = Wall((*vec)[0], (*vec)[1], (*vec)[2]);
+        Wall* wall = &adjusted;
+        Wall *wall_r = &walls[vec - data.begin()];
         if (vec != data.begin()) {
-            wall_r = new Wall(*wall); // copy wall for rendering before adjusting
+            *wall_r = *wall; // copy wall for rendering before adjusting
             wall->calc_dist(*wall_prev);  // calculate distance of center based on previous wall
             wall_r->calc_dist(*wall_prev_r);  // calculate distance of center based on previous wall
             if (wall_r->angle==135.0 && file_name == "environment2.csv") {
@@ -901,7 +1007,7 @@ std::vector<Object*> grid_util::create_angled_walls (std::string file_name) {
             wall_prev->c_x = wall->x - wall->width/2;
             wall_prev->c_y = wall->y;
             // copy wall for rendering
-            wall_r = new Wall(*wall); 
+            *wall_r = *wall;
             // std::cout << "First wall created with (x, y): " << wall->x << ", " << wall->y << std::endl;
         }
         if (wall->angle == 0) {
@@ -972,11 +1078,12 @@ std::vector<Object*> grid_util::create_angled_walls (std::string file_name) {
             this->min_y = wall->y;
         }
         walls_render.push_back(wall_r);
-        wall_prev = wall;        // update wall_prev
+        adjusted_prev = adjusted;        // update wall_prev
         wall_prev_r = wall_r;
         thick = wall->height;
-        delete wall;
     }
+    this->defer_fills = false;
+    this->fill_spans();
     // subtract wall thickness to get min/max y
     this->min_y += thick;
     this->max_y -= thick;
@@ -987,12 +1094,32 @@ std::vector<Object*> grid_util::create_angled_walls (std::string file_name) {
 
 // clear the -1 tolerance values after all objects have been spawned
 void grid_util::clear_tol() {
-    for (int i = 0; i < this->grid.size(); i++) {
-        for (int j = 0; j < this->grid[0].size(); j++) {
-            // if grid value is -1, make it 0, else stays the same
-            this->grid[i][j] = (this->grid[i][j]==-1)? 0: this->grid[i][j];
+    this->for_bands(0, this->grid.size(), [&](int lo, int hi) {
+        for (int i = lo; i < hi; i++) {
+            for (int j = 0; j < this->grid[0].size(); j++) {
+                // if grid value is -1, make it 0, else stays the same
+                this->grid[i][j] = (this->grid[i][j]==-1)? 0: this->grid[i][j];
+            }
         }
+    });
+}
+
+// f(lo, hi) over bands of [begin, end). the bands must not depend on each other
+void grid_util::for_bands(int begin, int end, const std::function<void(int, int)>& f, int grain) {
+    if (this->pool) {
+        this->pool->parallel_for(begin, end, grain, f);
     }
+    else {
+        f(begin, end);
+    }
+}
+
+void grid_util::set_pool(task_pool *pool) {
+    this->pool = pool;
+}
+
+const std::vector<std::vector<int>>& grid_util::get_grid() const {
+    return this->grid;
 }
 
 int grid_util::get_min_y() {
@@ -1040,71 +1167,83 @@ int grid_util::grid_value(int &&x, int &&y, int &x_q, int &y_q, int &range) {
     }
 }
 
+// counts are kept per band as integers and added up, so the result doesn't depend on the bands
 float grid_util::grid_accuracy(std::vector<std::vector<int>> grid_pred) {
-    float correct_count = 0.0;
-    float count = 0.0;
-    bool wall_found_l{false};
-    bool wall_found_r{false};
-
-    for (int j=0; j<this->grid.size(); j++) {
-        int i_b{799};
-        for (int i=0; i<this->grid.size()/2; i++) {
-            if (this->grid[i][j]) {
-                wall_found_l = true;
-                count ++;
-            }
-            if (this->grid[i_b][j]) {
-                wall_found_r = true;
-                count ++;
-            }
-            if (wall_found_l) {
-                correct_count += (this->grid[i][j] == grid_pred[i][j]);
-                // for the insides of the walls which are = 0
-                if (!this->grid[i][j]) {
-                    count++;
+    long correct_total = 0;
+    long total = 0;
+    std::mutex lock;
+
+    this->for_bands(0, this->grid.size(), [&](int lo, int hi) {
+        long correct_count = 0;
+        long count = 0;
+        for (int j=lo; j<hi; j++) {
+            bool wall_found_l{false};
+            bool wall_found_r{false};
+            int i_b{799};
+            for (int i=0; i<this->grid.size()/2; i++) {
+                if (this->grid[i][j]) {
+                    wall_found_l = true;
+                    count ++;
                 }
-            }
-            if (wall_found_r) {
-                correct_count += (this->grid[i_b][j] == grid_pred[i_b][j]);
-                // for the insides of the walls which are = 0
-                if (!this->grid[i_b][j]) {
-                    count++;
+                if (this->grid[i_b][j]) {
+                    wall_found_r = true;
+                    count ++;
+                }
+                if (wall_found_l) {
+                    correct_count += (this->grid[i][j] == grid_pred[i][j]);
+                    // for the insides of the walls which are = 0
+                    if (!this->grid[i][j]) {
+                        count++;
+                    }
                 }
+                if (wall_found_r) {
+                    correct_count += (this->grid[i_b][j] == grid_pred[i_b][j]);
+                    // for the insides of the walls which are = 0
+                    if (!this->grid[i_b][j]) {
+                        count++;
+                    }
+                }
+                i_b--;
             }
-            i_b--;
         }
-        // reset to false
-        wall_found_l = false;
-        wall_found_r = false;
-    }
-    return correct_count/count;
+        std::lock_guard<std::mutex> guard(lock);
+        correct_total += correct_count;
+        total += count;
+    });
+    return (float)correct_total/(float)total;
 }
 
 float grid_util::wall_accuracy(std::vector<std::vector<int>> grid_pred) {
-    float correct_count = 0.0;
-    float count = 0.0;
-    for (int i=0; i<this->grid.size(); i++) {
-        for (int j=0; j<grid[0].size(); j++) {
-            // count += (this->grid[i][j] == 1);
-            // correct_count += (grid_pred[i][j]==1);
-            if (this->min_y <= j && j < this->max_y) {
-                // if grid is 1 and it's beyong the min/max range
-                count += (this->grid[i][j]==1 
-                    && (i <= this->x_range[j-this->min_y][0]
-                    || i >= this->x_range[j-this->min_y][1])) ? 1: 0;
-                correct_count += (grid_pred[i][j]==1 
-                    && (i <= this->x_range[j-this->min_y][0]
-                    || i >= this->x_range[j-this->min_y][1])) ? 1: 0;
-            }
-            else {
-                count += (this->grid[i][j]==1);
-                correct_count += (grid_pred[i][j]==1);
-            }
+    long correct_total = 0;
+    long total = 0;
+    std::mutex lock;
+    this->for_bands(0, this->grid.size(), [&](int lo, int hi) {
+        long correct_count = 0;
+        long count = 0;
+        for (int i=lo; i<hi; i++) {
+            for (int j=0; j<grid[0].size(); j++) {
+                // count += (this->grid[i][j] == 1);
+                // correct_count += (grid_pred[i][j]==1);
+                if (this->min_y <= j && j < this->max_y) {
+                    // if grid is 1 and it's beyong the min/max range
+                    count += (this->grid[i][j]==1 
+                        && (i <= this->x_range[j-this->min_y][0]
+                        || i >= this->x_range[j-this->min_y][1])) ? 1: 0;
+                    correct_count += (grid_pred[i][j]==1 
+                        && (i <= this->x_range[j-this->min_y][0]
+                        || i >= this->x_range[j-this->min_y][1])) ? 1: 0;
+                }
+                else {
+                    count += (this->grid[i][j]==1);
+                    correct_count += (grid_pred[i][j]==1);
+                }
 
-            // correct_count += (grid_pred[i][j]==1);
+                // correct_count += (grid_pred[i][j]==1);
+            }
         }
-    }
-    // std::cout << "count: " << count << std::endl;
-    // std::cout << "correct_count: " << correct_count << std::endl;
-    return correct_count/count;
+        std::lock_guard<std::mutex> guard(lock);
+        correct_total += correct_count;
+        total += count;
+    });
+    return (float)correct_total/(float)total;
 }
\ No newline at end of file
@@ -3,18 +3,23 @@
 #ifndef UTIL
 #define UTIL
 
+#include <cstdint>
+#include <functional>
 #include <random>
 #include <iostream>
 #include <map>
 #include <string>
 #include <vector>
+#include "arena.h"
 
 // functions
 std::string trim(const std::string& );
+bool parse_int(const std::string&, int, int&);
 // std::pair<std::string, bool> read_csv();
 std::tuple<std::string, bool, int, int> read_csv();
 
 class grid_util;    //forward declaration
+class task_pool;
 
 // Object superclass
 class Object {
@@ -48,9 +53,15 @@ class random_generator {
     int env_size;   
     public:
         random_generator();
+        random_generator(unsigned);
         int create_random(int, int);
 };
 
+// cells [x_min, x_max] of row y set to val, for filling the grid in bands
+struct grid_span {
+    int y, x_min, x_max, val;
+};
+
 class grid_util {
     //Occupancy grid; outer vector represents rows, inner represents columns along each row, initialized to 0's
     std::vector<std::vector<int>> grid;
@@ -64,6 +75,19 @@ class grid_util {
         int max_y{0}, min_y{800};
         float wall_tol, wall_tol_b;
         std::vector<std::vector<int>> x_range;   //range of x values for a given y, starting at 0 for min_y
+        // lengths of the runs of blocking cells starting at each cell, flat x*env_height + y, one
+        // per direction (+x, -x, +y, -y). see build_runs()
+        std::vector<uint16_t> runs[4];
+        // owns the walls, obstacles and goal handed out below, freed with the environment
+        scene_arena arena;
+        // full grid passes split into bands of rows across this pool, serial if null
+        task_pool *pool{nullptr};
+        void for_bands(int, int, const std::function<void(int, int)>&, int grain = 32);
+        // fills made by occupy_grid and occupy_grid_wall, written by fill_spans. the walls are
+        // collected (defer_fills) and written in one pass
+        std::vector<grid_span> spans;
+        bool defer_fills{false};
+        void fill_spans();
     public:
         // constructor
         grid_util(const int&, const int&, const int&, const int&, const int&, const int&);
@@ -77,6 +101,8 @@ class grid_util {
         bool is_occupied (int, int, int, int, int);
         int is_collision(Object);
         void writeGridToCSV(const std::string&);
+        void build_runs(int);
+        int clearance(const Object&, int, int) const;
         std::vector<Object *> create_walls (std::string);
         std::vector<Object *> create_angled_walls (std::string);
         // int grid_value(int, int, int);
@@ -86,7 +112,10 @@ class grid_util {
         Object* spawn_object(random_generator&, const int&, int&&);
         float wall_accuracy(std::vector<std::vector<int>>);
         float grid_accuracy(std::vector<std::vector<int>>);
+        // setters
+        void set_pool(task_pool*);
         // getters
+        const std::vector<std::vector<int>>& get_grid() const;
         int get_min_y();
         int get_max_y();
 };